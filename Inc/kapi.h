@@ -153,6 +153,45 @@ K_ERR kMutexQuery( K_MUTEX *const kobj);
 
 #endif
 
+/*******************************************************************************
+ * SEQUENCE LOCK
+ *******************************************************************************/
+#if (K_DEF_SEQLOCK==ON)
+/**
+ *rief Init a sequence lock over a shared data object
+ *\param kobj 		Sequence lock address
+ *\param dataPtr 	Shared data, written only through kSeqLockWrite()
+ *\param size 		Data size in bytes
+ *
+eturn K_SUCCESS or specific error
+ */
+K_ERR kSeqLockInit( K_SEQLOCK *const kobj, ADDR const dataPtr,
+		ULONG const size);
+
+/**
+ *rief Updates the shared data. There must be a single writer, task or
+ *		 ISR. It never waits for readers.
+ *\param kobj 		Sequence lock address
+ *\param srcPtr 	New data (size bytes)
+ *
+eturn K_SUCCESS or specific error
+ */
+K_ERR kSeqLockWrite( K_SEQLOCK *const kobj, ADDR const srcPtr);
+
+/**
+ *rief Copies the shared data out, retrying if the writer changed it
+ *		 meanwhile. A task that finds the writer preempted mid-update
+ *		 sleeps for a tick so the writer can finish.
+ *\param kobj 		Sequence lock address
+ *\param dstPtr 	Address to store a consistent copy (size bytes)
+ *
+eturn K_SUCCESS, or K_ERR_SEQLOCK_BUSY when called from an ISR that
+ *		  interrupted the writer
+ */
+K_ERR kSeqLockRead( K_SEQLOCK *const kobj, ADDR const dstPtr);
+
+#endif
+
 /*******************************************************************************
  * MAILBOX (SINGLE-ITEM MAILBOX)
  *******************************************************************************/
@@ -235,6 +274,60 @@ BOOL kMboxIsFull( K_MBOX *const kobj);
 #endif
 
 #endif /* MBOX  */
+
+/*******************************************************************************
+ * CHANNELS (SEND-RECEIVE-REPLY)
+ *******************************************************************************/
+#if (K_DEF_CHANNEL == ON)
+
+/**
+ * \brief           Initialises a channel
+ * \param kobj      Channel address
+ * \return          K_SUCCESS or specific error
+ */
+K_ERR kChannelInit( K_CHANNEL *const kobj);
+
+/**
+ * \brief           Sends a request and blocks until the server replies.
+ *                  The server inherits the client priority while the
+ *                  request is pending or being served.
+ * \param kobj      Channel address
+ * \param sendPtr   Request
+ * \param replyPPtr Address to store the reply (may be NULL)
+ * \param timeout   Time to wait to be received (K_NO_WAIT: only if the
+ *                  server is waiting). Once received, the client waits
+ *                  for the reply.
+ * \return          K_SUCCESS, K_ERR_TIMEOUT or specific error
+ */
+K_ERR kChannelSend( K_CHANNEL *const kobj, ADDR const sendPtr,
+		ADDR *const replyPPtr, TICK const timeout);
+
+/**
+ * \brief           Receives the highest-priority pending request. The
+ *                  first task to receive on a channel is its server; only
+ *                  it can receive and reply.
+ * \param kobj      Channel address
+ * \param recvPPtr  Address to store the request
+ * \param clientPtr Address to store the client handle, to reply to
+ * \param timeout   Suspension time
+ * \return          K_SUCCESS, K_ERR_TIMEOUT or specific error
+ */
+K_ERR kChannelReceive( K_CHANNEL *const kobj, ADDR *const recvPPtr,
+		K_TASK_HANDLE *const clientPtr, TICK const timeout);
+
+/**
+ * \brief           Replies to a received client, readying it. Clients
+ *                  can be replied to in any order.
+ * \param kobj      Channel address
+ * \param clientPtr Client handle from kChannelReceive()
+ * \param replyPtr  Reply
+ * \return          K_SUCCESS or specific error
+ */
+K_ERR kChannelReply( K_CHANNEL *const kobj, K_TASK_HANDLE const clientPtr,
+		ADDR const replyPtr);
+
+#endif /* K_DEF_CHANNEL */
+
 /*******************************************************************************
  MESSAGE QUEUES (QUEUE AND STREAM)
 *******************************************************************************/
@@ -263,6 +356,25 @@ BOOL kMboxIsFull( K_MBOX *const kobj);
  * \return           K_SUCCESS or specific error.
  */
 K_ERR kQueueInit( K_QUEUE *const kobj, ADDR memPtr, ULONG maxItems);
+
+/**
+ * \brief			 Defines and initialises a mail queue at compile-time,
+ *                   with its storage. N must be a power of two, so indexes
+ *                   wrap with a mask. Use at file scope; no kQueueInit().
+ * \param name		 Queue name
+ * \param N			 Max number of mails
+ */
+#define K_QUEUE_DEFINE(name, N)                                              \
+	_Static_assert(((N) > 0) && (((N) & ((N) - 1)) == 0),                    \
+			#name ": N must be a power of two");                             \
+	static ADDR name##Buf_[N] __attribute__((aligned(4)));                   \
+	K_QUEUE name =                                                           \
+	{                                                                        \
+		.init = TRUE, .mailQPtr = name##Buf_, .maxItems = (N),               \
+		.idxMask = (N) - 1,                                                  \
+		.waitingQueue = K_LIST_STATIC_INIT( name.waitingQueue, "qq"),        \
+		.timeoutNode = { .objectType = QUEUE }                               \
+	}
 /**
  * \brief               Send to a multilbox. Task blocks when full.
  * \param kobj          Multibox address.
@@ -305,6 +417,38 @@ BOOL kQueueIsFull( K_QUEUE *const kobj);
 
 #endif
 
+#if (K_DEF_FUNC_QUEUE_BATCH==ON)
+/**
+ * \brief			 Posts up to n mails within a single critical region.
+ * \param kobj		 Queue address
+ * \param sendPPtr	 Array of n mails
+ * \param n			 Number of mails
+ * \param nPostedPtr Address to store the number posted (may be NULL)
+ * \param option	 K_BATCH_ALL: all n or none (waits for room for n)
+ *                   K_BATCH_ATLEAST1: waits for room for one, posts as
+ *                   many as fit
+ *                   K_BATCH_PARTIAL: posts as many as fit, never waits
+ * \param timeout	 Suspension time-out
+ * \return			 K_SUCCESS if any mail was posted, or specific error
+ */
+K_ERR kQueuePostN( K_QUEUE *const kobj, ADDR *const sendPPtr, ULONG const n,
+		ULONG *const nPostedPtr, ULONG const option, TICK const timeout);
+
+/**
+ * \brief			 Receives up to n mails within a single critical region.
+ * \param kobj		 Queue address
+ * \param recvPPtr	 Array to store up to n mails
+ * \param n			 Maximum number of mails
+ * \param nPendedPtr Address to store the number received (may be NULL)
+ * \param option	 K_BATCH_ALL, K_BATCH_ATLEAST1 or K_BATCH_PARTIAL
+ *                   (see kQueuePostN())
+ * \param timeout	 Suspension time-out
+ * \return			 K_SUCCESS if any mail was received, or specific error
+ */
+K_ERR kQueuePendN( K_QUEUE *const kobj, ADDR *const recvPPtr, ULONG const n,
+		ULONG *const nPendedPtr, ULONG const option, TICK const timeout);
+#endif
+
 #if (K_DEF_FUNC_QUEUE_MAILCOUNT==ON)
 /**
  * \brief			Gets the current number of mails within a queue.
@@ -315,8 +459,100 @@ ULONG kQueueMailCount( K_QUEUE *const kobj);
 
 #endif
 
+#if (K_DEF_FUNC_QUEUE_MARKS==ON)
+/**
+ * \brief			Sets wake-up watermarks, so consumers (and producers)
+ *                  working in batches take one switch per batch. A
+ *                  receiver blocked on an empty queue is woken once
+ *                  recvMark mails are in, or takes what is in when its
+ *                  time-out expires. A sender blocked on a full queue is
+ *                  woken once the mails are down to sendMark, or posts if
+ *                  there is room when its time-out expires.
+ *                  Defaults: recvMark 1, sendMark maxItems - 1.
+ * \param kobj      Queue address.
+ * \param recvMark  1 to maxItems.
+ * \param sendMark  0 to maxItems - 1.
+ * \return			K_SUCCESS or specific error.
+ */
+K_ERR kQueueSetMarks( K_QUEUE *const kobj, ULONG const recvMark,
+		ULONG const sendMark);
+
+#endif
+
 #endif /* MAIL QUEUE  */
 
+#if (K_DEF_PQUEUE == ON)
+
+/**
+ * \brief			 Initialises a priority mail queue: one ring of 'depth'
+ *                   mails per priority level. Receivers get the oldest mail
+ *                   of the highest priority level (0 is the highest).
+ * \param kobj		 Priority queue address
+ * \param memPtr     Buffer for nLevels * depth mail addresses
+ * \param nLevels    Number of priority levels (up to K_DEF_PQUEUE_LEVELS)
+ * \param depth      Max number of mails per level
+ * \return           K_SUCCESS or specific error.
+ */
+K_ERR kPQueueInit( K_PQUEUE *const kobj, ADDR const memPtr,
+		ULONG const nLevels, ULONG const depth);
+
+/**
+ * \brief			 Defines and initialises a priority mail queue at
+ *                   compile-time, with its storage. N must be a power of
+ *                   two. Use at file scope; no kPQueueInit().
+ * \param name		 Priority queue name
+ * \param L			 Number of priority levels
+ * \param N			 Max number of mails per level
+ */
+#define K_PQUEUE_DEFINE(name, L, N)                                          \
+	_Static_assert(((L) > 0) && ((L) <= K_DEF_PQUEUE_LEVELS),                \
+			#name ": invalid number of levels");                             \
+	_Static_assert(((N) > 0) && (((N) & ((N) - 1)) == 0),                    \
+			#name ": N must be a power of two");                             \
+	static ADDR name##Buf_[(L) * (N)] __attribute__((aligned(4)));           \
+	K_PQUEUE name =                                                          \
+	{                                                                        \
+		.init = TRUE, .mailQPtr = name##Buf_, .depth = (N),                  \
+		.idxMask = (N) - 1, .nLevels = (L),                                  \
+		.waitingQueue = K_LIST_STATIC_INIT( name.waitingQueue, "pqq"),       \
+		.timeoutNode = { .objectType = PQUEUE }                              \
+	}
+
+/**
+ * \brief               Posts a mail with a priority. The task blocks while
+ *                      the ring of that priority level is full; other
+ *                      levels are not affected.
+ * \param kobj          Priority queue address.
+ * \param sendPtr       Mail address.
+ * \param prio          Mail priority (0 is the highest, below nLevels).
+ * \param timeout		Suspension time-out
+ * \return              K_SUCCESS or specific error.
+ */
+K_ERR kPQueuePost( K_PQUEUE *const kobj, ADDR const sendPtr, PRIO const prio,
+		TICK const timeout);
+
+/**
+ * \brief               Receives the oldest mail of the highest priority
+ *                      level holding mails, in constant time. Blocks if
+ *                      the queue is empty.
+ * \param kobj          Priority queue address.
+ * \param recvPPtr      Address that will store the mail address.
+ * \param prioPtr       Address to store the mail priority (may be NULL).
+ * \param timeout		Suspension time-out
+ * \return				K_SUCCESS or specific error.
+ */
+K_ERR kPQueuePend( K_PQUEUE *const kobj, ADDR *const recvPPtr,
+		PRIO *const prioPtr, TICK const timeout);
+
+/**
+ * \brief			Gets the current number of mails, all levels.
+ * \param kobj      Priority queue address.
+ * \return			Number of mails.
+ */
+ULONG kPQueueMailCount( K_PQUEUE *const kobj);
+
+#endif /* PRIORITY MAIL QUEUE */
+
 #if (K_DEF_STREAM == ON)
 /**
  *\brief 			Initialise a Message Queue (Stream)
@@ -330,6 +566,62 @@ ULONG kQueueMailCount( K_QUEUE *const kobj);
 K_ERR kStreamInit( K_STREAM *const kobj, ADDR buffer, ULONG messageSize,
 		ULONG maxMessages);
 
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+/**
+ *\brief 			Initialise a lossy Message Queue (Stream): a send to a
+ *					full queue drops the oldest message instead of waiting,
+ *					so senders (e.g. ISRs feeding telemetry) have a fixed
+ *					cost and the backlog stays bounded. Sends never block
+ *					nor fail for lack of room; the time-out is not used.
+ *					kStreamSendN() keeps the newest messages of a batch
+ *					larger than the queue.
+ *					While a slot is held in place (zero-copy), messages
+ *					that find no room are dropped instead.
+ *					Jam and Reserve still wait as on kStreamInit().
+ *\param kobj		Message Queue address
+ *\param buffer		Allocated memory (messageSize*maxMessages)
+ *\param messageSize Message size
+ *\param maxMessage  Max number of messages
+ *\return 			 K_SUCCESS or specific errors
+ */
+K_ERR kStreamInitOvw( K_STREAM *const kobj, ADDR buffer, ULONG messageSize,
+		ULONG maxMessages);
+
+/**
+ *\brief 			Get the number of messages lost to overwrite since
+ *					kStreamInitOvw()
+ *\param kobj		(Stream) Queue address
+ *\param nDroppedPtr Address to store the number
+ *\return			K_SUCCESS or a specific error.
+ */
+K_ERR kStreamGetDropped( K_STREAM *const kobj, ULONG *const nDroppedPtr);
+#endif
+
+/**
+ *\brief 			Defines and initialises a Message Queue (Stream) at
+ *					compile-time, with its storage. N must be a power of
+ *					two, so indexes wrap with a mask, and the message type
+ *					a multiple of 4 bytes, so messages are copied by words.
+ *					Use at file scope; no kStreamInit().
+ *\param name		Stream name
+ *\param type		Message type
+ *\param N			Max number of messages
+ */
+#define K_STREAM_DEFINE(name, type, N)                                       \
+	_Static_assert(((N) > 0) && (((N) & ((N) - 1)) == 0),                    \
+			#name ": N must be a power of two");                             \
+	_Static_assert((sizeof(type) % 4) == 0,                                  \
+			#name ": message size must be a multiple of 4 bytes");           \
+	static type name##Buf_[N] __attribute__((aligned(4)));                   \
+	K_STREAM name =                                                          \
+	{                                                                        \
+		.init = TRUE, .mesgSize = sizeof(type),                              \
+		.mesgWords = sizeof(type) / 4, .maxMesg = (N), .idxMask = (N) - 1,   \
+		.buffer = name##Buf_,                                                \
+		.waitingQueue = K_LIST_STATIC_INIT( name.waitingQueue, #name),       \
+		.timeoutNode = { .objectType = STREAM }                              \
+	}
+
 #if (K_DEF_FUNC_STREAM_MESGCOUNT==ON)
 
 /**
@@ -343,6 +635,24 @@ K_ERR kStreamGetMesgCount( K_STREAM *const kobj, UINT *const mesgCntPtr);
 
 #endif
 
+#if (K_DEF_FUNC_STREAM_MARKS==ON)
+/**
+ *\brief 			Set wake-up watermarks. A receiver blocked on an empty
+ *					queue is woken once recvMark messages are in, or takes
+ *					what is in when its time-out expires. A sender blocked
+ *					on a full queue is woken once the messages are down to
+ *					sendMark, or sends if there is room when its time-out
+ *					expires. Defaults: recvMark 1, sendMark maxMesg - 1.
+ *\param kobj		(Stream) Queue address
+ *\param recvMark	1 to maxMesg
+ *\param sendMark	0 to maxMesg - 1
+ *\return			K_SUCCESS or a specific error.
+ */
+K_ERR kStreamSetMarks( K_STREAM *const kobj, ULONG const recvMark,
+		ULONG const sendMark);
+
+#endif
+
 #if (K_DEF_FUNC_STREAM_JAM == ON)
 
 /**
@@ -385,8 +695,474 @@ K_ERR kStreamPeek( K_STREAM *const kobj, ADDR recvPtr);
 
 #endif
 
+#if (K_DEF_FUNC_STREAM_BATCH==ON)
+
+/**
+ *\brief 			Send up to n messages, stored back to back, within a
+ *					single critical region
+ *\param kobj		(Stream) Queue address
+ *\param sendPtr	Address of n messages
+ *\param n			Number of messages
+ *\param nSentPtr	Address to store the number sent (may be NULL)
+ *\param option	K_BATCH_ALL: all n or none (waits for room for n)
+ *					K_BATCH_ATLEAST1: waits for room for one, sends as
+ *					many as fit
+ *					K_BATCH_PARTIAL: sends as many as fit, never waits
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS if any message was sent, or specific error
+ */
+K_ERR kStreamSendN( K_STREAM *const kobj, ADDR const sendPtr, ULONG const n,
+		ULONG *const nSentPtr, ULONG const option, TICK const timeout);
+
+/**
+ *\brief 			Receive up to n messages, stored back to back, within a
+ *					single critical region
+ *\param kobj		(Stream) Queue address
+ *\param recvPtr	Address with room for n messages
+ *\param n			Maximum number of messages
+ *\param nRecvPtr	Address to store the number received (may be NULL)
+ *\param option	K_BATCH_ALL, K_BATCH_ATLEAST1 or K_BATCH_PARTIAL
+ *					(see kStreamSendN())
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS if any message was received, or specific error
+ */
+K_ERR kStreamRecvN( K_STREAM *const kobj, ADDR const recvPtr, ULONG const n,
+		ULONG *const nRecvPtr, ULONG const option, TICK const timeout);
+
+#endif
+
+#if (K_DEF_FUNC_STREAM_ZEROCOPY==ON)
+
+/**
+ *\brief 			Reserve the tail slot of a queue to be written in place.
+ *					Blocks like kStreamSend() while there is no free slot
+ *					or another reservation is pending.
+ *\param kobj		(Stream) Queue address
+ *\param slotPPtr	Address to store the slot pointer (mesgSize bytes)
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kStreamReserve( K_STREAM *const kobj, ADDR *const slotPPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Publish the slot taken with kStreamReserve()
+ *\param kobj		(Stream) Queue address
+ *\return			K_SUCCESS, or K_ERROR if nothing is reserved
+ */
+K_ERR kStreamCommit( K_STREAM *const kobj);
+
+/**
+ *\brief 			Acquire the front message of a queue to be read in
+ *					place. Blocks like kStreamRecv() while the queue is
+ *					empty or another acquisition is pending.
+ *\param kobj		(Stream) Queue address
+ *\param slotPPtr	Address to store the slot pointer (mesgSize bytes)
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kStreamAcquire( K_STREAM *const kobj, ADDR *const slotPPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Remove the message taken with kStreamAcquire(),
+ *					freeing its slot
+ *\param kobj		(Stream) Queue address
+ *\return			K_SUCCESS, or K_ERROR if nothing is acquired
+ */
+K_ERR kStreamRelease( K_STREAM *const kobj);
+
+#endif
+
 #endif /*K_DEF_STREAM*/
 
+/*******************************************************************************
+ * PIPES
+ *******************************************************************************/
+#if (K_DEF_PIPE == ON)
+
+/**
+ *\brief 			Initialise a pipe: a byte ring of variable-size records.
+ *					Each record takes its size plus K_PIPE_HDR_SIZE bytes.
+ *\param kobj		Pipe address
+ *\param buffer		Storage
+ *\param size		Storage size in bytes (a power of two wraps faster)
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kPipeInit( K_PIPE *const kobj, ADDR const buffer, ULONG const size);
+
+/**
+ *\brief 			Send a record. Blocks until there is room for it whole.
+ *\param kobj		Pipe address
+ *\param sendPtr	Record address
+ *\param size		Record size in bytes (1 to K_PIPE_MAX_REC)
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kPipeSend( K_PIPE *const kobj, ADDR const sendPtr, ULONG const size,
+		TICK const timeout);
+
+/**
+ *\brief 			Receive the front record whole (or what is left of it,
+ *					after kPipeRead()).
+ *\param kobj		Pipe address
+ *\param recvPtr	Receiving address
+ *\param maxSize	Receiving buffer size
+ *\param sizePtr	Address to store the record size (may be NULL)
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS, or K_ERR_INVALID_MESG_SIZE if the record
+ *					does not fit (it stays in the pipe and its size is
+ *					stored), or specific error
+ */
+K_ERR kPipeRecv( K_PIPE *const kobj, ADDR const recvPtr, ULONG const maxSize,
+		ULONG *const sizePtr, TICK const timeout);
+
+/**
+ *\brief 			Read up to nBytes of the front record. The record leaves
+ *					the pipe once read to its end; reads never cross into
+ *					the next record.
+ *\param kobj		Pipe address
+ *\param recvPtr	Receiving address
+ *\param nBytes		Maximum number of bytes
+ *\param nReadPtr	Address to store the number of bytes read (may be NULL)
+ *\param timeout	Suspension time
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kPipeRead( K_PIPE *const kobj, ADDR const recvPtr, ULONG const nBytes,
+		ULONG *const nReadPtr, TICK const timeout);
+
+#endif /* K_DEF_PIPE */
+
+/*******************************************************************************
+ * SPSC RING
+ *******************************************************************************/
+#if (K_DEF_SPSC == ON)
+
+/**
+ *\brief 			Initialise a lock-free single-producer/single-consumer
+ *					ring of fixed-size records. Use a record size of 1 for
+ *					a byte ring.
+ *\param kobj		SPSC ring address
+ *\param buffer		Storage of recSize * nRecs bytes
+ *\param recSize	Record size in bytes
+ *\param nRecs		Max number of records (power of two)
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kSpscInit( K_SPSC *const kobj, ADDR const buffer, ULONG const recSize,
+		ULONG const nRecs);
+
+/**
+ *\brief 			Defines and initialises an SPSC ring at compile-time,
+ *					with its storage. Use at file scope; no kSpscInit().
+ *\param name		SPSC ring name
+ *\param type		Record type
+ *\param N			Max number of records (power of two)
+ */
+#define K_SPSC_DEFINE(name, type, N)                                         \
+	_Static_assert(((N) > 0) && (((N) & ((N) - 1)) == 0),                    \
+			#name ": N must be a power of two");                             \
+	static type name##Buf_[N] __attribute__((aligned(4)));                   \
+	K_SPSC name =                                                            \
+	{                                                                        \
+		.buffer = ( BYTE*) name##Buf_, .recSize = sizeof(type),              \
+		.nRecs = (N), .mask = (N) - 1,                                       \
+		.timeoutNode = { .objectType = SPSC }, .init = TRUE                  \
+	}
+
+/**
+ *\brief 			Write up to n records, stored back to back, as many as
+ *					fit. Wait-free: never blocks nor masks interrupts (but
+ *					to wake a blocked consumer). Only one producer, task or
+ *					ISR, may write to a ring.
+ *\param kobj		SPSC ring address
+ *\param srcPtr		Address of n records
+ *\param n			Number of records
+ *\return			Number of records written
+ */
+ULONG kSpscWrite( K_SPSC *const kobj, ADDR const srcPtr, ULONG const n);
+
+/**
+ *\brief 			Read up to n records, as many as available. Only one
+ *					consumer may read from a ring.
+ *\param kobj		SPSC ring address
+ *\param dstPtr		Address with room for n records
+ *\param n			Maximum number of records
+ *\param nReadPtr	Address to store the number read (may be NULL)
+ *\param timeout	Suspension time while the ring is empty
+ *\return			K_SUCCESS, K_ERR_STREAM_EMPTY, K_ERR_TIMEOUT or
+ *					specific error
+ */
+K_ERR kSpscRead( K_SPSC *const kobj, ADDR const dstPtr, ULONG const n,
+		ULONG *const nReadPtr, TICK const timeout);
+
+/**
+ *\brief 			Number of records in the ring (a snapshot)
+ *\param kobj		SPSC ring address
+ *\return			Number of records
+ */
+ULONG kSpscCount( K_SPSC const *const kobj);
+
+#endif /* K_DEF_SPSC */
+
+/*******************************************************************************
+ * MPSC QUEUE
+ *******************************************************************************/
+#if (K_DEF_MPSC == ON)
+
+/**
+ *\brief 			Initialise a lock-free multi-producer/single-consumer
+ *					queue of ADDR messages
+ *\param kobj		MPSC queue address
+ *\param cells		Array of nCells cells
+ *\param nCells		Max number of messages (power of two)
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kMpscInit( K_MPSC *const kobj, K_MPSC_CELL *const cells,
+		ULONG const nCells);
+
+/**
+ *\brief 			Post a message. Never blocks; safe from any task or
+ *					ISR, at any nesting level, without masking interrupts
+ *					(but to wake a blocked consumer).
+ *\param kobj		MPSC queue address
+ *\param mesgPtr	Message
+ *\return			K_SUCCESS, K_ERR_MBOX_FULL or specific error
+ */
+K_ERR kMpscPost( K_MPSC *const kobj, ADDR const mesgPtr);
+
+/**
+ *\brief 			Take the oldest message. Only one task may pend on a
+ *					queue.
+ *\param kobj		MPSC queue address
+ *\param recvPPtr	Address to store the message
+ *\param timeout	Suspension time while the queue is empty
+ *\return			K_SUCCESS, K_ERR_MBOX_EMPTY, K_ERR_TIMEOUT or
+ *					specific error
+ */
+K_ERR kMpscPend( K_MPSC *const kobj, ADDR *const recvPPtr, TICK const timeout);
+
+#endif /* K_DEF_MPSC */
+
+/*******************************************************************************
+ * BROADCAST RING
+ *******************************************************************************/
+#if (K_DEF_BCAST == ON)
+
+/**
+ *\brief 			Initialise a broadcast ring: one producer, and every
+ *					subscribed reader gets every message, in place
+ *\param kobj		Broadcast ring address
+ *\param buffer		Storage for recSize*nRecs bytes
+ *\param recSize	Message size in bytes
+ *\param nRecs		Number of slots (power of two)
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kBcastInit( K_BCAST *const kobj, ADDR const buffer, ULONG const recSize,
+		ULONG const nRecs);
+
+/**
+ *\brief 			Subscribe a reader. It gets the messages published
+ *					from now on, and holds the producer back when nRecs
+ *					behind.
+ *\param kobj		Broadcast ring address
+ *\param readerPtr	Reader, zero-initialised (or unsubscribed)
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kBcastSubscribe( K_BCAST *const kobj, K_BCAST_READER *const readerPtr);
+
+/**
+ *\brief 			Unsubscribe a reader; the producer no longer waits
+ *					for it
+ *\param readerPtr	Reader address
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kBcastUnsubscribe( K_BCAST_READER *const readerPtr);
+
+/**
+ *\brief 			Reserve the next slot to be written in place. Blocks
+ *					while the slowest reader has not read it yet.
+ *\param kobj		Broadcast ring address
+ *\param slotPPtr	Address to store the slot pointer (recSize bytes)
+ *\param timeout	Suspension time-out
+ *\return			K_SUCCESS, K_ERR_STREAM_FULL, K_ERR_TIMEOUT or
+ *					specific error
+ */
+K_ERR kBcastReserve( K_BCAST *const kobj, ADDR *const slotPPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Publish the slot taken with kBcastReserve() to every
+ *					reader
+ *\param kobj		Broadcast ring address
+ *\return			K_SUCCESS, or K_ERROR if nothing is reserved
+ */
+K_ERR kBcastCommit( K_BCAST *const kobj);
+
+/**
+ *\brief 			Copy a message into the next slot and publish it
+ *					(kBcastReserve() and kBcastCommit())
+ *\param kobj		Broadcast ring address
+ *\param srcPtr		Message (recSize bytes)
+ *\param timeout	Suspension time-out
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kBcastPublish( K_BCAST *const kobj, ADDR const srcPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Get the next message of a reader, in place. Blocks
+ *					while the reader has read everything published.
+ *\param readerPtr	Reader address
+ *\param slotPPtr	Address to store the message pointer
+ *\param timeout	Suspension time-out
+ *\return			K_SUCCESS, K_ERR_STREAM_EMPTY, K_ERR_TIMEOUT or
+ *					specific error
+ */
+K_ERR kBcastAcquire( K_BCAST_READER *const readerPtr, ADDR *const slotPPtr,
+		TICK const timeout);
+
+/**
+ *\brief 			Done with the message got by kBcastAcquire(); its slot
+ *					can be reused once every reader has released it
+ *\param readerPtr	Reader address
+ *\return			K_SUCCESS or specific error
+ */
+K_ERR kBcastRelease( K_BCAST_READER *const readerPtr);
+
+/**
+ *\brief 			Number of messages a reader has yet to read
+ *\param readerPtr	Reader address
+ *\return			Number of messages
+ */
+ULONG kBcastPending( K_BCAST_READER const *const readerPtr);
+
+#endif /* K_DEF_BCAST */
+
+/*******************************************************************************
+ * REFERENCE-COUNTED MESSAGES
+ *******************************************************************************/
+#if (K_DEF_MSGREF == ON)
+
+/**
+ * \brief          Allocates a reference-counted message from a block pool.
+ *                 The pool block size must be K_MSG_BLK_SIZE(payload size).
+ * \param memPtr   Pointer to the block pool
+ * \return         Pointer to the payload, with one reference, or NULL
+ */
+ADDR kMsgAlloc( K_MEM *const memPtr);
+
+/**
+ * \brief          Adds a reference to a message (atomic)
+ * \param msgPtr   Message returned by kMsgAlloc()
+ * \return         K_SUCCESS, or K_ERROR if the message was released
+ */
+K_ERR kMsgRef( ADDR const msgPtr);
+
+/**
+ * \brief          Drops a reference to a message (atomic). The last one
+ *                 returns the block to its pool.
+ * \param msgPtr   Message returned by kMsgAlloc()
+ * \return         K_SUCCESS or specific error
+ */
+K_ERR kMsgUnref( ADDR const msgPtr);
+
+/**
+ * \brief          Current number of references of a message
+ * \param msgPtr   Message returned by kMsgAlloc()
+ * \return         Reference count
+ */
+ULONG kMsgRefCount( ADDR const msgPtr);
+
+#if (K_DEF_QUEUE == ON)
+/**
+ * \brief          Posts a message to a queue adding a reference for the
+ *                 receiver, who calls kMsgUnref() when done. The reference
+ *                 is dropped if the post fails.
+ * \param kobj     Queue address
+ * \param msgPtr   Message returned by kMsgAlloc()
+ * \param timeout  Suspension time-out
+ * \return         K_SUCCESS or specific error
+ */
+K_ERR kMsgQueuePost( K_QUEUE *const kobj, ADDR const msgPtr,
+		TICK const timeout);
+#endif
+
+#if (K_DEF_MBOX == ON)
+/**
+ * \brief          Posts a message to a mailbox adding a reference for the
+ *                 receiver, who calls kMsgUnref() when done. The reference
+ *                 is dropped if the post fails.
+ * \param kobj     Mailbox address
+ * \param msgPtr   Message returned by kMsgAlloc()
+ * \param timeout  Suspension time-out
+ * \return         K_SUCCESS or specific error
+ */
+K_ERR kMsgMboxPost( K_MBOX *const kobj, ADDR const msgPtr, TICK const timeout);
+#endif
+
+#endif /* K_DEF_MSGREF */
+
+/*******************************************************************************
+ * PUBLISH-SUBSCRIBE
+ *******************************************************************************/
+#if (K_DEF_PUBSUB == ON)
+
+/**
+ * \brief          Initialises a topic
+ * \param kobj     Topic address
+ * \param name     Topic name
+ * \return         K_SUCCESS or specific error
+ */
+K_ERR kTopicInit( K_TOPIC *const kobj, STRING const name);
+
+/**
+ * \brief          Defines and initialises a topic at compile-time. Use at
+ *                 file scope; no kTopicInit().
+ * \param topic    Topic name
+ */
+#define K_TOPIC_DEFINE(topic) \
+	K_TOPIC topic = { .name = #topic, .subsPtr = NULL, .nSubs = 0, .init = TRUE }
+
+/**
+ * \brief          Subscribes a queue to a topic
+ * \param kobj     Topic address
+ * \param subPtr   Subscriber record, kept by the caller while subscribed
+ *                 (zero-initialise it before the first subscription)
+ * \param queuePtr Queue the messages are delivered to
+ * \param filter   Called as filter(msgPtr, filterArgsPtr) within a
+ *                 critical region; delivers if TRUE. NULL takes all.
+ * \param filterArgsPtr Filter arguments
+ * \return         K_SUCCESS, K_ERROR if subPtr is already subscribed, or
+ *                 specific error
+ */
+K_ERR kSubscribe( K_TOPIC *const kobj, K_SUBSCRIBER *const subPtr,
+		K_QUEUE *const queuePtr, MSGFILTER const filter,
+		ADDR const filterArgsPtr);
+
+/**
+ * \brief          Removes a subscriber from its topic
+ * \param subPtr   Subscriber record
+ * \return         K_SUCCESS, or K_ERROR if not subscribed
+ */
+K_ERR kUnsubscribe( K_SUBSCRIBER *const subPtr);
+
+/**
+ * \brief          Delivers a message to every subscriber of a topic whose
+ *                 filter takes it, by pointer, adding a reference per
+ *                 delivery (see kMsgQueuePost()). Never blocks: a full
+ *                 queue counts a drop on its subscriber (nDropped). The
+ *                 publisher releases its own reference when done.
+ * \param kobj     Topic address
+ * \param msgPtr   Message returned by kMsgAlloc()
+ * \param nDeliveredPtr Address to store the number of deliveries
+ *                 (may be NULL)
+ * \return         K_SUCCESS or specific error
+ */
+K_ERR kPublish( K_TOPIC *const kobj, ADDR const msgPtr,
+		ULONG *const nDeliveredPtr);
+
+#endif /* K_DEF_PUBSUB */
+
 /*******************************************************************************
  * PUMP-DROP LIFO QUEUE (CYCLIC ASYNCHRONOUS BUFFERS - CABs)
  *******************************************************************************/
@@ -395,57 +1171,71 @@ K_ERR kStreamPeek( K_STREAM *const kobj, ADDR recvPtr);
 
 /**
  * \brief               Pump-drop Message Control Block initialisation.
- *                      This initialisation associates a pool of buffers
- *                      to a unique control block.
+ *                      Each PD Buffer of the pool gets a data area of
+ *                      dataSize bytes. No method blocks nor disables
+ *                      interrupts, so writers and readers can be tasks
+ *                      or ISRs.
  *
  * \param kobj    	    PD Control Block address.
- * \param memCtrlPtr	Pointer to the memory allocator control block
  * \param bufPool  		Pool of PD Buffers, statically allocated.
- * \param nBufs    		Number of buffers for this queue.
+ * \param dataPool		Data areas, nBufs * dataSize bytes.
+ * \param dataSize		Max message size.
+ * \param nBufs    		Number of buffers: at least the number of readers
+ *                      that can hold a buffer at once plus 2.
  * \return         K_SUCCESS or specific error
  */
-K_ERR kPDMesgInit( K_PDMESG *const kobj, K_MEM *const memCtrlPtr,
-		K_PDBUF *const bufPool, BYTE const nBufs);
+K_ERR kPDMesgInit( K_PDMESG *const kobj, K_PDBUF *const bufPool,
+		ADDR const dataPool, ULONG const dataSize, ULONG const nBufs);
 
 /**
- * \brief          Reserves a pump-drop buffer before writing on it.
+ * \brief          Reserves a free pump-drop buffer before writing on it.
+ *                 Never waits.
  * \param kobj     PD Message Control address.
- * \return         K_SUCCESS or specific error
+ * \return         Buffer address, or NULL if all buffers are in use
+ *                 (counted in failReserve).
  */
 K_PDBUF* kPDMesgReserve( K_PDMESG *const kobj);
 /**
- * \brief           Writes into a PD buffer the source address and the size
- *                  of a data message.
+ * \brief           Copies a message into a reserved PD buffer. A writer can
+ *                  also fill bufPtr->dataPtr in place and set dataSize.
  * \param bufPtr    Buffer address.
  * \param srcPtr    Message address.
  * \param dataSize  Message size.
  * \return			K_SUCCESS or specific error.
  */
-K_ERR kPDBufWrite( K_PDBUF *bufPtr, ADDR srcPtr, ULONG dataSize);
+K_ERR kPDBufWrite( K_PDBUF *const bufPtr, ADDR const srcPtr,
+		ULONG const dataSize);
 
 /**
- * \brief          Pump a buffer into the queue - make it available for readers.
+ * \brief          Pump a reserved buffer into the queue: it becomes the
+ *                 newest message, and the one it replaces is reused once
+ *                 its readers drop it.
  *
  * \param kobj     LIFO address.
- * \return         Address of a written PD buffer.
+ * \param bufPtr   Buffer returned by kPDMesgReserve().
+ * \return         K_SUCCESS or specific error
  */
-K_ERR kPDMesgPump( K_PDMESG *const kobj, K_PDBUF *bufPtr);
+K_ERR kPDMesgPump( K_PDMESG *const kobj, K_PDBUF *const bufPtr);
 
 /**
- * \brief          Fetches the most recent buffer pumped in the queue.
+ * \brief          Fetches the most recent buffer pumped in the queue. The
+ *                 message is read in place (bufPtr->dataPtr, dataSize)
+ *                 and stays intact until kPDMesgDrop().
  *
  * \param kobj     LIFO address.
- * \return         Address of a PD buffer available for reading.
+ * \return         Address of a PD buffer available for reading, or NULL
+ *                 if nothing was pumped yet.
  */
 K_PDBUF* kPDMesgFetch( K_PDMESG *const kobj);
 
 /**
- * \brief          Copies the message from a PD Buffer to a chosen address.
+ * \brief          Copies the message from a fetched PD Buffer to a chosen
+ *                 address.
  * \param bufPtr   Address of the PD buffer.
  * \param destPtr  Address that will store the message.
  * \return         K_SUCCESS or specific error
  */
-K_ERR kPDBufRead( K_PDBUF *const bufPtr, ADDR destPtr);
+K_ERR kPDBufRead( K_PDBUF *const bufPtr, ADDR const destPtr);
 
 /**
  * \brief         Called by reader to indicate it has consumed the
@@ -453,6 +1243,7 @@ K_ERR kPDBufRead( K_PDBUF *const bufPtr, ADDR destPtr);
  *                using the buffer, and it is not the last buffer pumped
  *                in the queue, it will be reused.
  * \param kobj    Queue address;
+ * \param bufPtr  Buffer returned by kPDMesgFetch().
  * \return        K_SUCCESS or specific error
  */
 K_ERR kPDMesgDrop( K_PDMESG *const kobj, K_PDBUF *const bufPtr);
@@ -618,6 +1409,59 @@ inline K_ERR kCondVarBroad( K_EVENT *eventPtr);
 
 #endif
 
+/******************************************************************************
+ * WAIT SETS
+ ******************************************************************************/
+#if (K_DEF_WAITSET==ON)
+/**
+ * \brief 			Initialise a wait set. Initialising a set again takes
+ *					all of its objects out.
+ * \param kobj		Pointer to K_WAIT_SET object
+ * \return			K_SUCCESS/error
+ */
+K_ERR kWaitSetInit( K_WAIT_SET *const kobj);
+
+/**
+ * \brief 			Add an initialised object to a set. Its index is the
+ *					number of objects added before it. An object belongs
+ *					to one set at most.
+ * \param kobj		Pointer to K_WAIT_SET object
+ * \param objectType QUEUE, STREAM, PIPE, SEMAPHORE or EVENT
+ * \param objPtr	Pointer to the object
+ * \return			K_SUCCESS/error
+ */
+K_ERR kWaitSetAdd( K_WAIT_SET *const kobj, K_OBJ_TYPE const objectType,
+		ADDR const objPtr);
+
+/**
+ * \brief 			Take an object out of a set, so it can be added to
+ *					another one. The objects added after it move down one
+ *					index. A set must not go out of scope with objects
+ *					still in it.
+ * \param kobj		Pointer to K_WAIT_SET object
+ * \param objPtr	Pointer to the object
+ * \return			K_SUCCESS, K_ERROR if the object is not in the set,
+ *					or specific error
+ */
+K_ERR kWaitSetRemove( K_WAIT_SET *const kobj, ADDR const objPtr);
+
+/**
+ * \brief 			Suspends a task until any object of a set is ready:
+ *					a Queue, Stream or Pipe holds a message, a Semaphore
+ *					can be taken, an Event was signalled (latched until
+ *					reported). Objects are checked in the order they were
+ *					added. The caller then takes from the object with
+ *					K_NO_WAIT; this can still fail if a task waiting on
+ *					the object itself was faster.
+ * \param kobj		Pointer to K_WAIT_SET object
+ * \param idxPtr	Address to store the index of the ready object
+ * \param timeout	Suspension time
+ * \return			K_SUCCESS, K_ERR_TIMEOUT, or specific error
+ */
+K_ERR kWaitAny( K_WAIT_SET *const kobj, ULONG *const idxPtr, TICK const timeout);
+
+#endif
+
 #if (K_DEF_CALLOUT_TIMER==ON)
 /*******************************************************************************
  * APPLICATION TIMER AND DELAY
@@ -662,22 +1506,56 @@ VOID kSleepUntil( TICK period);
  */
 TICK kTickGet( VOID);
 
+/**
+ * \brief  Gets the 64-bit monotonic tick count. It does not wrap for the
+ *         device lifetime and is safe to call from tasks and ISRs without
+ *         disabling interrupts.
+ * \return Number of ticks since kInit()
+ */
+TICK64 kTimeNow64( VOID);
+
+/**
+ * \brief  Converts an absolute deadline into a relative timeout to be
+ *         passed to any blocking method, e.g.:
+ *         kSemaWait( &sema, kTimeUntil( deadline));
+ * \param deadline Absolute time (kTimeNow64() scale)
+ * \return Remaining ticks. K_NO_WAIT if the deadline has been met.
+ */
+TICK kTimeUntil( TICK64 const deadline);
+
+/**
+ * \brief Put the current task to sleep until an absolute time.
+ *        Returns immediately if the deadline has been met.
+ * \param deadline Absolute wake time (kTimeNow64() scale)
+ */
+VOID kSleepUntilTime( TICK64 const deadline);
+
+/**
+ * \brief Time units to ticks, folded at compile-time when the argument is a
+ *        constant. Rounded up, so a non-zero time is never shorter than
+ *        asked for. (\see K_DEF_TICK_PERIOD_US)
+ */
+#define K_US(us) \
+    (( TICK) ((( TICK64) (us) + K_DEF_TICK_PERIOD_US - 1) / K_DEF_TICK_PERIOD_US))
+#define K_MS(ms) K_US(( TICK64) (ms) * 1000ULL)
+
 #if (K_DEF_ALLOC==ON)
 /*******************************************************************************
  * BLOCK MEMORY POOL
  ******************************************************************************/
 
 /**
- * \brief Memory Pool Control Block Initialisation
+ * \brief Memory Pool Control Block Initialisation. It is O(1): blocks
+ *        are linked on the free list only after being used.
  * \param kobj Pointer to a pool control block
  * \param memPoolPtr Address of a pool (typically an array) \
  * 		  of objects to be handled
- * \param blkSize Size of each block in bytes
+ * \param blkSize Size of each block in bytes (rounded up to a multiple of 4)
  * \param numBlocks Number of blocks
  * \return K_ERROR/K_SUCCESS
  */
-K_ERR kMemInit( K_MEM *const kobj, ADDR const memPoolPtr, BYTE blkSize,
-		BYTE const numBlocks);
+K_ERR kMemInit( K_MEM *const kobj, ADDR const memPoolPtr, ULONG blkSize,
+		ULONG const numBlocks);
 
 /**
  * \brief Allocate memory from a block pool
@@ -693,6 +1571,238 @@ ADDR kMemAlloc( K_MEM *const kobj);
  * \return Pointer to the allocated memory. NULL on failure.
  */
 K_ERR kMemFree( K_MEM *const kobj, ADDR const blockPtr);
+
+/**
+ * \brief Allocate up to n blocks from a block pool at once, within a
+ *        single critical region
+ * \param kobj Pointer to the block pool
+ * \param ptrs Array to store the allocated blocks
+ * \param n Number of blocks requested
+ * \return Number of blocks allocated (less than n if the pool ran out)
+ */
+ULONG kMemAllocN( K_MEM *const kobj, ADDR *const ptrs, ULONG const n);
+
+/**
+ * \brief Free n blocks back to a block pool at once. The blocks are
+ *        linked outside the critical region and spliced onto the free
+ *        list in one step. Either all or none are freed.
+ * \param kobj Pointer to the block pool
+ * \param ptrs Array of blocks to free
+ * \param n Number of blocks
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kMemFreeN( K_MEM *const kobj, ADDR *const ptrs, ULONG const n);
+
+/**
+ * \brief Free a chain of blocks, linked through their first word and
+ *        ended by NULL, back to a block pool at once
+ * \param kobj Pointer to the block pool
+ * \param headPtr First block of the chain
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kMemFreeChain( K_MEM *const kobj, ADDR const headPtr);
+
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+/**
+ * \brief Allocate memory from a block pool. If the pool is empty the
+ *        caller blocks until a block is freed or the timeout expires.
+ *        Waiters are served by priority; kMemFree() hands the block
+ *        directly to the highest priority waiter.
+ * \param kobj Pointer to the block pool
+ * \param timeout Suspension time-out (K_NO_WAIT behaves as kMemAlloc())
+ * \return Pointer to the allocated block, or NULL on timeout/failure
+ */
+ADDR kMemAllocWait( K_MEM *const kobj, TICK const timeout);
+#endif
+
+#if (K_DEF_ALLOC_CHECK==ON)
+/**
+ * \brief Attach an allocation bitmap to a block pool. kMemFree() then
+ *        returns K_ERR_MEM_DOUBLE_FREE for a block that is not allocated.
+ *        Addresses out of the pool or misaligned are always rejected with
+ *        K_ERR_MEM_FOREIGN on checked builds.
+ *        Must be called after kMemInit() and before any allocation.
+ * \param kobj Pointer to the block pool
+ * \param mapPtr Array of K_MEM_MAP_WORDS(numBlocks) words
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kMemCheckInit( K_MEM *const kobj, ULONG *const mapPtr);
+#endif
+
+#if (K_DEF_ALLOC_STATS==ON)
+/**
+ * \brief Read the usage statistics of a block pool. The allocation rate is
+ *        measured since the previous call (or kMemInit()).
+ * \param kobj Pointer to the block pool
+ * \param statsPtr Address to store the snapshot
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kMemGetStats( K_MEM *const kobj, K_MEM_STATS *const statsPtr);
+
+/**
+ * \brief Set a low-watermark callback, called when an allocation leaves
+ *        exactly 'lowMark' free blocks. It runs on the allocating task or
+ *        ISR, so it must be short and non-blocking (e.g., signal a task).
+ * \param kobj Pointer to the block pool
+ * \param lowMark Number of free blocks (less than the pool size)
+ * \param cbk Callback (NULL disables it)
+ * \param argsPtr Callback argument
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kMemSetLowMark( K_MEM *const kobj, ULONG const lowMark, CBK const cbk,
+		ADDR const argsPtr);
+#endif
+
+#if (K_DEF_ALLOC_CLASSES==ON)
+
+/**
+ * \brief Size-Class Allocator Initialisation
+ * \param kobj Pointer to a size-class control block
+ * \param poolsPtr Array of initialised block pools, ordered by
+ *        ascending block size
+ * \param nPools Number of pools
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kMemClassInit( K_MEMCLASS *const kobj, K_MEM *const poolsPtr,
+		ULONG const nPools);
+
+/**
+ * \brief Allocate a block of at least 'size' bytes from the smallest
+ *        fitting class. Lookup is a table access and a scan of the classes
+ *        within one power of two of 'size'; if that class is exhausted,
+ *        larger classes are tried.
+ * \param kobj Pointer to a size-class control block
+ * \param size Number of bytes
+ * \return Pointer to the allocated block, or NULL on failure
+ */
+ADDR kMemAllocSize( K_MEMCLASS *const kobj, ULONG const size);
+
+/**
+ * \brief Free a block allocated with kMemAllocSize()
+ * \param kobj Pointer to a size-class control block
+ * \param blockPtr Pointer to the block to free
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kMemFreeSize( K_MEMCLASS *const kobj, ADDR const blockPtr);
+
+#endif
+
+#if (K_DEF_ALLOC_ARENA==ON)
+/*******************************************************************************
+ * ARENA
+ *******************************************************************************/
+/**
+ * \brief Arena Initialisation over a caller-provided buffer
+ * \param kobj Pointer to an arena
+ * \param bufPtr Buffer address
+ * \param size Buffer size in bytes
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kArenaInit( K_ARENA *const kobj, ADDR const bufPtr, ULONG const size);
+
+/**
+ * \brief Arena Initialisation over a block taken from a pool. The block
+ *        goes back to the pool on kArenaRelease().
+ * \param kobj Pointer to an arena
+ * \param memPtr Pointer to a block pool
+ * \return K_SUCCESS, or K_ERR_MEM_ALLOC if the pool is empty
+ */
+K_ERR kArenaInitMem( K_ARENA *const kobj, K_MEM *const memPtr);
+
+/**
+ * \brief Release an arena. If it was taken from a pool, the block is
+ *        freed.
+ * \param kobj Pointer to an arena
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kArenaRelease( K_ARENA *const kobj);
+
+/**
+ * \brief Allocate from an arena. There is no individual free: memory is
+ *        reclaimed with kArenaRestore() or kArenaReset().
+ * \param kobj Pointer to an arena
+ * \param size Number of bytes
+ * \param align Alignment, a power of two (0: word alignment)
+ * \return Pointer to the allocated memory, or NULL on failure
+ */
+ADDR kArenaAlloc( K_ARENA *const kobj, ULONG const size, ULONG align);
+
+/**
+ * \brief Get a mark of the current arena usage
+ * \param kobj Pointer to an arena
+ * \return Mark to be passed to kArenaRestore()
+ */
+ULONG kArenaMark( K_ARENA *const kobj);
+
+/**
+ * \brief Drop every allocation made after a mark
+ * \param kobj Pointer to an arena
+ * \param mark Value returned by kArenaMark()
+ * \return K_SUCCESS, or K_ERROR if the mark is no longer valid
+ */
+K_ERR kArenaRestore( K_ARENA *const kobj, ULONG const mark);
+
+/**
+ * \brief Drop every allocation of an arena
+ * \param kobj Pointer to an arena
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kArenaReset( K_ARENA *const kobj);
+
+/**
+ * \brief Number of bytes left in an arena (ignoring alignment padding)
+ * \param kobj Pointer to an arena
+ * \return Free bytes
+ */
+ULONG kArenaFreeBytes( K_ARENA *const kobj);
+#endif
+#endif
+
+#if (K_DEF_HEAP==ON)
+/*******************************************************************************
+ * TLSF HEAP
+ ******************************************************************************/
+
+/**
+ * \brief Initialises a TLSF heap over a memory region
+ * \param kobj Pointer to a heap control block
+ * \param memPtr Address of the region (typically an array)
+ * \param memSize Region size in bytes
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kHeapInit( K_HEAP *const kobj, ADDR const memPtr, ULONG const memSize);
+
+/**
+ * \brief Allocate a variable-size block in constant time.
+ *        Returned address is 8-byte aligned.
+ * \param kobj Pointer to a heap control block
+ * \param size Number of bytes
+ * \return Pointer to the allocated memory, or NULL on failure
+ */
+ADDR kHeapAlloc( K_HEAP *const kobj, ULONG const size);
+
+/**
+ * \brief Free a block back to the heap in constant time, merging it with
+ *        free neighbours.
+ * \param kobj Pointer to a heap control block
+ * \param ptr Address returned by kHeapAlloc()
+ * \return K_SUCCESS or specific error
+ */
+K_ERR kHeapFree( K_HEAP *const kobj, ADDR const ptr);
+
+/**
+ * \brief Returns the number of free bytes in a heap
+ */
+ULONG kHeapFreeBytes( K_HEAP *const kobj);
+
+#ifndef NDEBUG
+/**
+ * \brief Walks the heap checking its integrity (debug builds). O(n).
+ * \return K_SUCCESS if consistent, K_ERROR otherwise
+ */
+K_ERR kHeapCheck( K_HEAP *const kobj);
+#endif
+
 #endif
 /*******************************************************************************
  * MISC
@@ -21,6 +21,12 @@
  *   Users can define it, as they wish, by configuring SysTick.
  *   Recommended value is 5ms.
  *
+ * - **Tick Period in microseconds:** (`K_DEF_TICK_PERIOD_US`)
+ *   The same period expressed in microseconds. It is used to convert time
+ *   units into ticks at compile-time (`K_MS()`, `K_US()`), since
+ *   `K_DEF_TICK_PERIOD` is a SysTick reload value that depends on
+ *   SystemCoreClock. Keep both in sync.
+ *
  * - **Queue Discipline**: blocking mechanisms that can change the queue dis
  *   cipline are either by priority  (`K_DEF_ENQ_PRIO`) or FIFO (`K_DEF_ENQ_FIFO`).
  *   Default/fallback value is by priority.
@@ -52,6 +58,7 @@
 /**/
 /*** [ Time Quantum ] *********************************************************/
 #define K_DEF_TICK_PERIOD               (TICK_1MS)
+#define K_DEF_TICK_PERIOD_US            (1000UL)
 
 /**/
 /*** [ Number of user-defined tasks ] *****************************************/
@@ -73,6 +80,43 @@
 /*** [ Mmeory Allocator ] *****************************************************/
 #define K_DEF_ALLOC						(ON)
 
+#if (K_DEF_ALLOC==ON)
+/* Size-class allocator over several block pools (kMemAllocSize()) */
+#define K_DEF_ALLOC_CLASSES				(ON)
+/* Blocking allocation (kMemAllocWait()) - waiters are enqueued by priority */
+#define K_DEF_FUNC_MEM_ALLOCWAIT		(ON)
+/* Lock-free pool free list (LDREX/STREX), so kMemAlloc()/kMemFree() never
+ * mask interrupts. Pools are limited to 65535 blocks. ARMv6-M has no
+ * exclusive access and keeps the critical region.                           */
+#ifndef K_DEF_ALLOC_LOCKFREE
+#define K_DEF_ALLOC_LOCKFREE			(OFF)
+#endif
+/* Per-pool statistics (kMemGetStats()) and low-watermark callback          */
+#define K_DEF_ALLOC_STATS				(ON)
+/* Allocation bitmap catching double and foreign frees (kMemCheckInit()).
+ * On by default on checked (non-NDEBUG) builds.                             */
+#ifndef NDEBUG
+#define K_DEF_ALLOC_CHECK				(ON)
+#else
+#define K_DEF_ALLOC_CHECK				(OFF)
+#endif
+/* Arena (bump-pointer region) allocator with O(1) reset (kArenaAlloc())    */
+#define K_DEF_ALLOC_ARENA				(ON)
+#endif
+
+/**/
+/*** [ TLSF Heap ] ************************************************************/
+/* Two-Level Segregated Fit variable-size allocator: O(1) alloc/free */
+#define K_DEF_HEAP						(ON)
+
+#if (K_DEF_HEAP==ON)
+/* log2 of the upper bound of a heap block size (16: up to 64KB blocks)      */
+#define K_DEF_HEAP_FL_MAX				(16)
+/* log2 of the number of lists per power-of-two class. More lists, less
+ * internal fragmentation, more RAM for the control block.                   */
+#define K_DEF_HEAP_SL_LOG2				(4)
+#endif
+
 /**/
 /*** [ Dynamic priority change ] **********************************************/
 /* Enables the methods kTaskChangePrio() and kTaskRestorePrio() to act on
@@ -101,6 +145,13 @@
 #define K_DEF_MUTEX_ENQ				    (K_DEF_ENQ_PRIO)
 #endif
 
+/**/
+/*** [ Sequence Locks ] *******************************************************/
+/* Shared data with one writer (task or ISR) and many readers that copy it
+ * out and retry on a torn read. Nobody masks interrupts nor blocks the
+ * writer.                                                                   */
+#define K_DEF_SEQLOCK                   (ON)
+
 /**/
 /*** [ Sleep/Wake Events ] ****************************************************/
 #define K_DEF_EVENT                 (ON)
@@ -133,6 +184,12 @@
 #endif
 #endif
 
+/**/
+/*** [ Channel ] **************************************************************/
+/* Synchronous send-receive-reply between many clients and one server task.
+ * The server inherits the priority of its highest-priority client.         */
+#define K_DEF_CHANNEL                   (ON)
+
 /**/
 /*** [ Queue ] ****************************************************************/
 
@@ -148,6 +205,22 @@
 #define K_DEF_FUNC_QUEUE_PEEK			(ON)
 #define K_DEF_FUNC_QUEUE_MAILCOUNT		(ON)
 #define K_DEF_FUNC_QUEUE_JAM			(ON)
+#define K_DEF_FUNC_QUEUE_BATCH			(ON)
+/* Wake-up watermarks (kQueueSetMarks()) */
+#define K_DEF_FUNC_QUEUE_MARKS			(ON)
+#endif
+
+/**/
+/*** [ Priority Queue ] *******************************************************/
+/* Mail queue ordered by mail priority: one ring per priority level and a
+ * bitmap of non-empty levels, so both post and pend are O(1).               */
+#define K_DEF_PQUEUE                     (ON)
+
+#if (K_DEF_PQUEUE == ON)
+/* Queue discipline:   				 */
+#define K_DEF_PQUEUE_ENQ                 (K_DEF_ENQ_PRIO)
+/* Number of mail priority levels (up to 32); 0 is the highest               */
+#define K_DEF_PQUEUE_LEVELS              (4)
 #endif
 
 /**/
@@ -164,12 +237,77 @@
 #define K_DEF_FUNC_STREAM_PEEK			 (ON)
 #define K_DEF_FUNC_STREAM_MESGCOUNT		 (ON)
 #define K_DEF_FUNC_STREAM_RESET			 (ON)
+#define K_DEF_FUNC_STREAM_BATCH			 (ON)
+/* Zero-copy access: kStreamReserve()/Commit() and kStreamAcquire()/Release() */
+#define K_DEF_FUNC_STREAM_ZEROCOPY		 (ON)
+/* Wake-up watermarks (kStreamSetMarks()) */
+#define K_DEF_FUNC_STREAM_MARKS			 (ON)
+/* Overwrite-oldest streams (kStreamInitOvw()) */
+#define K_DEF_FUNC_STREAM_OVW			 (ON)
 
 #endif /*mesgq*/
 
+/**/
+/*** [ Pipe ] *****************************************************************/
+/* Byte ring of variable-size, length-prefixed records                       */
+#define K_DEF_PIPE                       (ON)
+
+#if (K_DEF_PIPE == ON)
+/* Queue Discipline				 */
+#define K_DEF_PIPE_ENQ                   (K_DEF_ENQ_PRIO)
+#endif
+
+/**/
+/*** [ SPSC Ring ] ************************************************************/
+/* Lock-free single-producer/single-consumer ring, e.g. ISR-to-task data.
+ * The producer never blocks nor masks interrupts; the consumer may block.  */
+#define K_DEF_SPSC                       (ON)
+
+/**/
+/*** [ MPSC Queue ] ***********************************************************/
+/* Lock-free multi-producer/single-consumer queue of ADDR messages. Producers
+ * (tasks or nested ISRs) reserve slots with an atomic compare-and-swap.     */
+#define K_DEF_MPSC                       (ON)
+
+/**/
+/*** [ Broadcast Ring ] *******************************************************/
+/* Single-producer ring read in place by every subscribed consumer, each
+ * with its own cursor. The producer is held back by the slowest one.       */
+#define K_DEF_BCAST                      (ON)
+
+#if (K_DEF_BCAST == ON)
+/* Queue Discipline				 */
+#define K_DEF_BCAST_ENQ                  (K_DEF_ENQ_PRIO)
+#endif
+
 /**/
 /*** [ Pump-Drop Buffers ] ****************************************************/
-#define K_DEF_PDMESG                     (OFF)
+/* Lock-free latest-value buffers: writers never block, readers take the
+ * newest complete message in place. Tasks and ISRs alike.                   */
+#define K_DEF_PDMESG                     (ON)
+
+/**/
+/*** [ Reference-Counted Messages ] *******************************************/
+/* Pool blocks carrying a reference count, for zero-copy fan-out through
+ * Queues and Mailboxes (kMsgAlloc()). Requires K_DEF_ALLOC.                 */
+#define K_DEF_MSGREF                     (ON)
+
+/**/
+/*** [ Publish-Subscribe ] ****************************************************/
+/* Topics fan reference-counted messages out to subscriber Queues by
+ * pointer (kPublish()). Requires K_DEF_MSGREF and K_DEF_QUEUE.             */
+#define K_DEF_PUBSUB                     (ON)
+
+/**/
+/*** [ Wait Sets ] ************************************************************/
+/* A task blocks on several Queues, Streams, Pipes, Semaphores and Events at
+ * once (kWaitAny()).                                                        */
+#define K_DEF_WAITSET                    (ON)
+
+#if (K_DEF_WAITSET == ON)
+/* Max objects in a set (up to 32)                                           */
+#define K_DEF_WAITSET_MAX                (8)
+#endif
 
 
 #endif /* KCONFIG_H */
@@ -23,6 +23,9 @@
 #if (K_DEF_ALLOC == ON)
 #include "kmem.h"
 #endif
+#if (K_DEF_HEAP == ON)
+#include "kheap.h"
+#endif
 #include "kitc.h"
 #include "ktimer.h"
 #include "ksystasks.h"
@@ -0,0 +1,31 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o TLSF Heap (variable-size allocator)
+ *
+ *****************************************************************************/
+
+#ifndef KHEAP_H
+#define KHEAP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+K_ERR kHeapInit(K_HEAP* const, ADDR const, ULONG const);
+ADDR kHeapAlloc(K_HEAP* const, ULONG const);
+K_ERR kHeapFree(K_HEAP* const, ADDR const);
+ULONG kHeapFreeBytes(K_HEAP* const);
+#ifndef NDEBUG
+K_ERR kHeapCheck(K_HEAP* const);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,6 +18,19 @@ extern "C"
 #include "kconfig.h"
 #include "kenv.h"
 
+	/* Exclusive access (LDREX/STREX) is available on ARMv7-M and later.
+	 * ARMv6-M falls back to interrupt masking; host builds use C11 atomics */
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) \
+	|| defined(__ARM_ARCH_8M_MAIN__)
+#define K_ARCH_EXCLUSIVE (1)
+#elif !defined(__arm__)
+#define K_ARCH_EXCLUSIVE (0)
+#define K_HOST_ATOMICS
+#include <stdatomic.h>
+#else
+#define K_ARCH_EXCLUSIVE (0)
+#endif
+
 	/*
 	 * brief This is the offset w.r.t the top of a stack frame
 	 * The numbers are unsigned.
@@ -55,6 +68,11 @@ extern "C"
 #define K_AND_CLEAR	 (K_ALL_CLEAR)
 #define K_MAIL		 (5)
 
+	/* Batch transfer options (kQueuePostN(), kStreamSendN(), ...) */
+#define K_BATCH_ALL       (1) /* all or nothing */
+#define K_BATCH_ATLEAST1  (2) /* wait for one, move as many as possible */
+#define K_BATCH_PARTIAL   (3) /* move as many as possible, never wait */
+
 	/*** Config values */
 
 #define TIMHANDLER_ID               255
@@ -73,6 +91,14 @@ extern "C"
 #define KFAULT				kErrHandler
 #define DEADCODE            (0)
 	/* inline asm */
+#if defined(K_HOST_ATOMICS)
+	/* host builds (test/): C11 fences, never in an ISR */
+#define DMB								atomic_thread_fence(memory_order_seq_cst);
+#define DSB								atomic_thread_fence(memory_order_seq_cst);
+#define ISB								atomic_thread_fence(memory_order_seq_cst);
+#define NOP                             ;
+ #define _K_STUP ;
+#else
 #define DMB								asm volatile ("dmb 0xF":::"memory");
 #define DSB								asm volatile ("dsb 0xF":::"memory");
 #define ISB								asm volatile ("isb 0xF":::"memory");
@@ -80,35 +106,84 @@ extern "C"
 
 	/*_ means assembly hardwired code parms */
  #define _K_STUP asm volatile("svc #0xAA");
+#endif
 
 	/*  helpers */
 
+	/* copy engine is in kutils.h */
 #define CPY(d,s,z, r)                                 \
  do                                                   \
  {                                                    \
-      BYTE* dt = (BYTE*) d;                           \
-      BYTE const* st = (BYTE const*) s;               \
-      r=0;                                            \
-     for (ULONG i = 0; i < z; ++i)                     \
-      {                                               \
-          dt[i] = st[i];                              \
-          r ++;                                       \
-      }                                               \
+      r = kCpy( (d), (s), (z));                       \
   } while(0U)
 
-	/*todo: improve copy by advancing dst and src and reusing
-	 * as indexes for mesgq
-	 */
 #define CPYQ(d,s,z,r) CPY(d,s,z,r)
 
 	__STATIC_FORCEINLINE unsigned kIsISR( void)
 	{
+#if defined(K_HOST_ATOMICS)
+		return (0);
+#else
 		unsigned ipsr_value;
 		asm("MRS %0, IPSR" : "=r"(ipsr_value));
 		DMB
 		return (ipsr_value);
+#endif
+	}
+
+	/* Atomic compare-and-swap on a 32-bit word. Safe from tasks and ISRs.
+	 * Returns 1 if *addr held 'expected' and was replaced by 'desired'.
+	 * An exception between LDREX and STREX clears the exclusive monitor,
+	 * so the store fails and the update is retried. */
+	__STATIC_FORCEINLINE int kAtomicCAS( volatile unsigned long *addr,
+			unsigned long expected, unsigned long desired)
+	{
+#if (K_ARCH_EXCLUSIVE)
+		do
+		{
+			if (__LDREXW( ( volatile uint32_t*) addr) != expected)
+			{
+				__CLREX();
+				return (0);
+			}
+		} while (__STREXW( desired, ( volatile uint32_t*) addr));
+		DMB
+		return (1);
+#elif defined(K_HOST_ATOMICS)
+		return (atomic_compare_exchange_strong(
+				( _Atomic unsigned long*) addr, &expected, desired));
+#else
+		int ret = 0;
+		unsigned primask = __get_PRIMASK();
+		__disable_irq();
+		if (*addr == expected)
+		{
+			*addr = desired;
+			ret = 1;
+		}
+		__set_PRIMASK( primask);
+		return (ret);
+#endif
+	}
+
+	/* Atomically adds 'delta' to *addr, returns the updated value. */
+	__STATIC_FORCEINLINE unsigned long kAtomicAdd( volatile unsigned long *addr,
+			long delta)
+	{
+		unsigned long old;
+		do
+		{
+			old = *addr;
+		} while (!kAtomicCAS( addr, old, old + delta));
+		return (old + delta);
 	}
 
+#if ((K_DEF_ALLOC_LOCKFREE==ON) && !defined(__ARM_ARCH_6M__))
+#define K_MEM_LOCKFREE (ON)
+#else
+#define K_MEM_LOCKFREE (OFF)
+#endif
+
 #define K_GET_CONTAINER_ADDR(memberPtr, containerType, memberName) \
     ((containerType *)((unsigned char *)(memberPtr) - \
      offsetof(containerType, memberName)))
@@ -34,6 +34,20 @@ K_ERR kEventSignal( K_EVENT* const);
 K_ERR kEventSleep( K_EVENT*, TICK);
 #endif
 
+#if (K_DEF_WAITSET==ON)
+/* called within the object's critical region whenever it may have become
+ * ready: marks it and readies the task blocked in kWaitAny(), if any */
+VOID kWaitSetNotify( K_WAIT_SET *const, ULONG const);
+#define K_WAITSET_NOTIFY(kobj)                                   \
+	do                                                           \
+	{                                                            \
+		if ((kobj)->waitSetPtr != NULL)                          \
+			kWaitSetNotify( (kobj)->waitSetPtr, (kobj)->waitSetBit); \
+	} while (0U)
+#else
+#define K_WAITSET_NOTIFY(kobj)
+#endif
+
 #if (K_DEF_EVENT_FLAGS==ON)
 
 K_ERR kEventFlagsSet( K_EVENT* const, ULONG, ULONG*, ULONG);
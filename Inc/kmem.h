@@ -5,9 +5,39 @@
 extern "C" {
 #endif
 
-K_ERR kMemInit(K_MEM* const, ADDR const, BYTE const, BYTE);
+K_ERR kMemInit(K_MEM* const, ADDR const, ULONG, ULONG const);
 ADDR kMemAlloc(K_MEM* const);
 K_ERR kMemFree(K_MEM* const, ADDR const);
+ULONG kMemAllocN(K_MEM* const, ADDR* const, ULONG const);
+K_ERR kMemFreeN(K_MEM* const, ADDR* const, ULONG const);
+K_ERR kMemFreeChain(K_MEM* const, ADDR const);
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+ADDR kMemAllocWait(K_MEM* const, TICK const);
+#endif
+#if (K_DEF_ALLOC_CHECK==ON)
+K_ERR kMemCheckInit(K_MEM* const, ULONG* const);
+#endif
+#if (K_DEF_ALLOC_STATS==ON)
+K_ERR kMemGetStats(K_MEM* const, K_MEM_STATS* const);
+K_ERR kMemSetLowMark(K_MEM* const, ULONG const, CBK const, ADDR const);
+#endif
+
+#if (K_DEF_ALLOC_CLASSES==ON)
+K_ERR kMemClassInit(K_MEMCLASS* const, K_MEM* const, ULONG const);
+ADDR kMemAllocSize(K_MEMCLASS* const, ULONG const);
+K_ERR kMemFreeSize(K_MEMCLASS* const, ADDR const);
+#endif
+
+#if (K_DEF_ALLOC_ARENA==ON)
+K_ERR kArenaInit(K_ARENA* const, ADDR const, ULONG const);
+K_ERR kArenaInitMem(K_ARENA* const, K_MEM* const);
+K_ERR kArenaRelease(K_ARENA* const);
+ADDR kArenaAlloc(K_ARENA* const, ULONG const, ULONG);
+ULONG kArenaMark(K_ARENA* const);
+K_ERR kArenaRestore(K_ARENA* const, ULONG const);
+K_ERR kArenaReset(K_ARENA* const);
+ULONG kArenaFreeBytes(K_ARENA* const);
+#endif
 
 #ifdef __cplusplus
 }
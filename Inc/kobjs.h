@@ -23,6 +23,9 @@ typedef enum
 #if (K_DEF_QUEUE==ON)
 	QUEUE,
 #endif
+#if (K_DEF_PQUEUE==ON)
+	PQUEUE,
+#endif
 #if (K_DEF_SEMA==ON)
 	SEMAPHORE,
 #endif
@@ -37,6 +40,24 @@ typedef enum
 #endif
 #if(K_DEF_CALLOUT_TIMER==ON)
 	TIMER,
+#endif
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+	MEMPOOL,
+#endif
+#if (K_DEF_WAITSET==ON)
+	WAITSET,
+#endif
+#if (K_DEF_PIPE==ON)
+	PIPE,
+#endif
+#if (K_DEF_SPSC==ON)
+	SPSC,
+#endif
+#if (K_DEF_MPSC==ON)
+	MPSC,
+#endif
+#if (K_DEF_BCAST==ON)
+	BCAST,
 #endif
 	TASK_HANDLE,
 	NONE
@@ -78,6 +99,13 @@ struct kList
 	BOOL init;
 };
 
+/* static initialiser of an empty list */
+#define K_LIST_STATIC_INIT(list, name)                                      \
+	{                                                                       \
+		.listDummy = { &(list).listDummy, &(list).listDummy },              \
+		.listName = (name), .size = 0, .init = TRUE                         \
+	}
+
 struct kTcb
 {
 	/* Don't change */
@@ -90,8 +118,12 @@ struct kTcb
 	UINT stackSize;
 	PID pid; /* System-defined task ID */
 	PRIO priority; /* Task priority (0-31) 32 is invalid */
-#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) )
+#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) \
+		|| (K_DEF_CHANNEL==ON) )
 	PRIO realPrio; /* Real priority  */
+#endif
+#if (K_DEF_MUTEX_PRIO_INH==ON)
+	PRIO mutexPrio; /* priority inherited through mutexes, or realPrio */
 #endif
 	BOOL   signalled; /* private binary semaphore */
 #if ((K_DEF_TASK_FLAGS==ON) || (K_DEF_EVENT_FLAGS==ON))
@@ -112,6 +144,14 @@ struct kTcb
 	BOOL runToCompl;
 	BOOL yield;
 	BOOL timeOut;
+	ADDR xferPtr; /* item handed over directly on wake-up */
+#if ((K_DEF_QUEUE==ON) || (K_DEF_STREAM==ON) || (K_DEF_PIPE==ON) \
+		|| (K_DEF_PQUEUE==ON) || (K_DEF_BCAST==ON))
+	ULONG waitNeed; /* what a blocked send/receive waits for (kMesgWake_) */
+#endif
+#if (K_DEF_CHANNEL==ON)
+	struct kChannel *chanPtr; /* channel it is a client of, or NULL */
+#endif
 	/* Monitoring */
 	UINT nPreempted;
 	PID preemptedBy;
@@ -136,6 +176,10 @@ struct kSema
 	struct kTcb *owner;
 	struct kList waitingQueue;
 	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_WAITSET==ON)
+	struct kWaitSet *waitSetPtr; /* set this object belongs to, or NULL */
+	ULONG waitSetBit;
+#endif
 };
 
 #endif
@@ -152,6 +196,17 @@ struct kMutex
 };
 #endif
 
+#if (K_DEF_SEQLOCK==ON)
+
+struct kSeqLock
+{
+	volatile ULONG seq; /* odd while the writer is updating the data */
+	ADDR dataPtr;
+	ULONG size;
+	BOOL init;
+};
+#endif
+
 #if (K_DEF_EVENT==ON)
 
 struct kEvent
@@ -162,28 +217,149 @@ struct kEvent
 	ULONG eventFlags;
 #endif
 	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_WAITSET==ON)
+	struct kWaitSet *waitSetPtr; /* set this object belongs to, or NULL */
+	ULONG waitSetBit;
+#endif
 
 };
 
 #endif /* K_DEF_EVENT */
 
-#if (K_DEF_ALLOC==ON)
+#if (K_DEF_WAITSET==ON)
+
+struct kWaitSetItem
+{
+	K_OBJ_TYPE objectType; /* QUEUE, STREAM, PIPE, SEMAPHORE or EVENT */
+	ADDR objPtr;
+};
+
+struct kWaitSet
+{
+	struct kWaitSetItem items[K_DEF_WAITSET_MAX];
+	ULONG nItems;
+	ULONG signalled; /* bit i: item i was signalled since last checked */
+	struct kTcb *ownerPtr; /* task blocked in kWaitAny(), or NULL */
+	K_TIMEOUT_NODE timeoutNode;
+	BOOL init;
+};
 
-#define MEMBLKLAST (0)
+#endif
+
+#if (K_DEF_ALLOC==ON)
 
 /* Fixed-size pool memory control block (BLOCK POOL) */
 struct kMemBlock
 {
+#if (K_MEM_LOCKFREE==ON)
+	/* tagged head: ABA tag (16 bits) | head block index + 1 (16 bits) */
+	volatile ULONG freeHead;
+	volatile ULONG bumpIdx; /* next never-used block index */
+#else
 	BYTE *freeListPtr;
+	BYTE *bumpPtr; /* next never-used block */
+	ULONG nBumpBlocks; /* never-used blocks left */
+#endif
 	BYTE *poolPtr;
 	ULONG blkSize;
+	ULONG nMaxBlocks;
+	volatile ULONG nFreeBlocks;
+#if (K_DEF_ALLOC_STATS==ON)
+	volatile ULONG minFreeBlocks; /* lowest nFreeBlocks ever */
+	volatile ULONG nAllocs; /* successful allocations */
+	volatile ULONG nAllocFails; /* allocations that found the pool empty */
+	ULONG rateAllocs; /* nAllocs at the last rate sample */
+	TICK64 rateTick; /* time of the last rate sample */
+	ULONG lowMark; /* low-watermark, in free blocks */
+	CBK lowMarkCbk; /* called when nFreeBlocks drops to lowMark */
+	ADDR lowMarkArgsPtr;
+#endif
+#if (K_DEF_ALLOC_CHECK==ON)
+	volatile ULONG *allocMapPtr; /* 1 bit per block: set while allocated */
+#endif
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+	struct kList waitingQueue;
+	K_TIMEOUT_NODE timeoutNode;
+#endif
+	BOOL init;
+};
+
+#if (K_DEF_ALLOC_STATS==ON)
+/* Snapshot of a block pool usage */
+struct kMemStats
+{
 	ULONG nMaxBlocks;
 	ULONG nFreeBlocks;
-#if (MEMBLKLAST)
-	BYTE* lastUsed;
+	ULONG minFreeBlocks;
+	ULONG nAllocs;
+	ULONG nAllocFails;
+	ULONG allocsPerSec; /* since the previous kMemGetStats() */
+};
+#endif
+
+#if (K_DEF_ALLOC_CHECK==ON)
+/* number of words of an allocation bitmap for a pool of nBlocks */
+#define K_MEM_MAP_WORDS(nBlocks) \
+	(((nBlocks) + (8 * sizeof(ULONG)) - 1) / (8 * sizeof(ULONG)))
+#endif
+
+#if (K_DEF_ALLOC_CLASSES==ON)
+
+#define K_MEM_CLASS_N_OCTAVES (32)
+#define K_MEM_CLASS_MAX_POOLS (255)
+
+/* Size-class allocator: block pools ordered by ascending block size */
+struct kMemClass
+{
+	struct kMemBlock *poolsPtr;
+	ULONG nPools;
+	BYTE classTbl[K_MEM_CLASS_N_OCTAVES]; /* log2(size) -> pool index */
+	BOOL init;
+};
+#endif
+
+#if (K_DEF_ALLOC_ARENA==ON)
+/* Arena: bump-pointer region, released all at once */
+struct kArena
+{
+	BYTE *basePtr;
+	ULONG size;
+	ULONG offset; /* first unused byte */
+	struct kMemBlock *memPtr; /* pool the region came from, if any */
+	BOOL init;
+};
 #endif
+#endif
+
+#if (K_DEF_HEAP==ON)
+
+#define K_HEAP_ALIGN_LOG2  (3)
+#define K_HEAP_ALIGN       (1UL << K_HEAP_ALIGN_LOG2)
+#define K_HEAP_SL_COUNT    (1UL << K_DEF_HEAP_SL_LOG2)
+#define K_HEAP_FL_SHIFT    (K_DEF_HEAP_SL_LOG2 + K_HEAP_ALIGN_LOG2)
+#define K_HEAP_FL_COUNT    (K_DEF_HEAP_FL_MAX - K_HEAP_FL_SHIFT + 1)
+
+/* TLSF heap block header. Payload follows the header. */
+struct kHeapBlock
+{
+	struct kHeapBlock *prevPhysPtr; /* valid when previous block is free */
+	ULONG size; /* payload size | bit 0: free | bit 1: previous free */
+	/* valid while on a free list only (overlaps payload) */
+	struct kHeapBlock *nextFreePtr;
+	struct kHeapBlock *prevFreePtr;
+};
+
+/* TLSF heap control block */
+struct kHeap
+{
+	ULONG flBitmap;
+	ULONG slBitmap[K_HEAP_FL_COUNT];
+	struct kHeapBlock *freeLists[K_HEAP_FL_COUNT][K_HEAP_SL_COUNT];
+	struct kHeapBlock *firstBlockPtr;
+	ULONG nFreeBytes;
 	BOOL init;
 };
+
 #endif
 
 #if (K_DEF_MBOX==ON)
@@ -201,6 +377,17 @@ struct kMailbox
 } __attribute__((aligned(4)));
 #endif
 
+#if (K_DEF_CHANNEL==ON)
+struct kChannel
+{
+	BOOL init;
+	struct kTcb *serverPtr; /* set by the first kChannelReceive() */
+	BOOL serverWaiting; /* server blocked in kChannelReceive() */
+	struct kList clientQueue; /* clients to be received, by priority */
+	struct kList replyQueue; /* clients received, waiting for a reply */
+} __attribute__((aligned(4)));
+#endif
+
 #if (K_DEF_QUEUE==ON)
 struct kQ
 {
@@ -209,10 +396,39 @@ struct kQ
 	ULONG headIdx;
 	ULONG tailIdx;
 	ULONG maxItems;
+	ULONG idxMask; /* maxItems - 1 if a power of two, else 0 */
 	ULONG countItems;
+#if (K_DEF_FUNC_QUEUE_MARKS==ON)
+	ULONG recvMark; /* receivers are woken with this many mails in */
+	ULONG sendRoom; /* senders are woken with this many free slots */
+#endif
 	K_TCB* port;
 	struct kList waitingQueue;
 	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_WAITSET==ON)
+	struct kWaitSet *waitSetPtr; /* set this object belongs to, or NULL */
+	ULONG waitSetBit;
+#endif
+} __attribute__((aligned(4)));
+#endif
+
+
+#if (K_DEF_PQUEUE==ON)
+
+/* Priority Mail Queue: a ring of 'depth' mails per priority level */
+struct kPQueue
+{
+	BOOL init;
+	ADDR *mailQPtr; /* nLevels rings of depth mails, level 0 first */
+	ULONG depth;
+	ULONG idxMask; /* depth - 1 if a power of two, else 0 */
+	ULONG nLevels;
+	ULONG levelMask; /* bit n set: level n holds mails */
+	ULONG headIdx[K_DEF_PQUEUE_LEVELS];
+	ULONG countLevel[K_DEF_PQUEUE_LEVELS];
+	ULONG countItems;
+	struct kList waitingQueue;
+	K_TIMEOUT_NODE timeoutNode;
 } __attribute__((aligned(4)));
 #endif
 
@@ -223,17 +439,130 @@ struct kStream
 {
 	BOOL init;
 	ULONG mesgSize;
+	ULONG mesgWords; /* words per message on the word-copy path, or 0 */
 	ULONG maxMesg;
+	ULONG idxMask; /* maxMesg - 1 if a power of two, else 0 */
 	ULONG mesgCnt;
 	ADDR buffer;
 	ULONG readIndex;
 	ULONG writeIndex;
+#if (K_DEF_FUNC_STREAM_ZEROCOPY==ON)
+	BOOL reserved; /* slot at writeIndex is being filled in place */
+	BOOL acquired; /* slot at readIndex is being read in place */
+#endif
+#if (K_DEF_FUNC_STREAM_MARKS==ON)
+	ULONG recvMark; /* receivers are woken with this many messages in */
+	ULONG sendRoom; /* senders are woken with this many free slots */
+#endif
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+	BOOL overwrite; /* a send to a full stream drops the oldest message */
+	ULONG nDropped; /* messages lost to overwrite */
+#endif
 	struct kList waitingQueue;
 	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_WAITSET==ON)
+	struct kWaitSet *waitSetPtr; /* set this object belongs to, or NULL */
+	ULONG waitSetBit;
+#endif
 } __attribute__((aligned(4)));
 
 #endif /*K_DEF_MSG_QUEUE*/
 
+#if (K_DEF_PIPE==ON)
+
+/* records are stored as a K_PIPE_HDR_SIZE-byte length, little-endian,
+ * followed by the payload; both may wrap at the end of the buffer */
+#define K_PIPE_HDR_SIZE (2)
+#define K_PIPE_MAX_REC  (0xFFFF)
+
+struct kPipe
+{
+	BOOL init;
+	BYTE *buffer;
+	ULONG size; /* bytes */
+	ULONG idxMask; /* size - 1 if a power of two, else 0 */
+	ULONG readIndex;
+	ULONG writeIndex;
+	ULONG byteCnt; /* bytes in use, headers included */
+	ULONG recCnt; /* records, the one being read in parts included */
+	ULONG recLeft; /* bytes left of a record being read in parts, or 0 */
+	struct kList waitingQueue;
+	K_TIMEOUT_NODE timeoutNode;
+#if (K_DEF_WAITSET==ON)
+	struct kWaitSet *waitSetPtr; /* set this object belongs to, or NULL */
+	ULONG waitSetBit;
+#endif
+} __attribute__((aligned(4)));
+
+#endif
+
+#if (K_DEF_SPSC==ON)
+
+struct kSpsc
+{
+	BYTE *buffer;
+	ULONG recSize; /* bytes per record; 1 for a byte ring */
+	ULONG nRecs; /* power of two */
+	ULONG mask; /* nRecs - 1 */
+	volatile ULONG head; /* free-running, written by the producer only */
+	volatile ULONG tail; /* free-running, written by the consumer only */
+	struct kTcb *volatile readerPtr; /* consumer blocked on empty, or NULL */
+	K_TIMEOUT_NODE timeoutNode;
+	BOOL init;
+} __attribute__((aligned(4)));
+
+#endif
+
+#if (K_DEF_MPSC==ON)
+
+struct kMpscCell
+{
+	volatile ULONG seq; /* position this cell is free (or full) for */
+	ADDR mesgPtr;
+};
+
+struct kMpsc
+{
+	struct kMpscCell *cells;
+	ULONG nCells; /* power of two */
+	ULONG mask; /* nCells - 1 */
+	volatile ULONG postPos; /* next position to reserve, CAS by producers */
+	ULONG pendPos; /* next position to take, consumer only */
+	struct kTcb *volatile readerPtr; /* consumer blocked on empty, or NULL */
+	K_TIMEOUT_NODE timeoutNode;
+	BOOL init;
+} __attribute__((aligned(4)));
+
+#endif
+
+#if (K_DEF_BCAST==ON)
+
+/* Broadcast Ring consumer */
+struct kBcastReader
+{
+	struct kBcastReader *nextPtr;
+	struct kBcast *bcastPtr; /* ring it reads from, or NULL */
+	volatile ULONG seq; /* next message to read */
+};
+
+/* Broadcast Ring: messages are numbered; message n is in slot (n & mask) */
+struct kBcast
+{
+	BOOL init;
+	BYTE *buffer;
+	ULONG recSize;
+	ULONG nRecs; /* power of two */
+	ULONG mask; /* nRecs - 1 */
+	volatile ULONG cursor; /* number of messages published */
+	BOOL reserved; /* the producer holds slot (cursor & mask) */
+	struct kBcastReader *readersPtr;
+	ULONG nReaders;
+	struct kList waitingQueue;
+	K_TIMEOUT_NODE timeoutNode;
+} __attribute__((aligned(4)));
+
+#endif
+
 #if (K_DEF_PDMESG== ON)
 
 struct kPumpDropBuf
@@ -241,18 +570,53 @@ struct kPumpDropBuf
 
 	ADDR dataPtr;
 	ULONG dataSize; /* mesg size in this buf */
-	ULONG nUsers; /* number of tasks using */
+	ULONG bufSize; /* capacity of dataPtr */
+	/* readers using it (low half), writer and newest flags (kmesg.c) */
+	volatile ULONG state;
 };
 struct kPumpDropQueue
 {
-	struct kMemBlock *memCtrlPtr; /* associated allocator */
-	struct kPumpDropBuf *currBufPtr; /* current buffer   */
-	UINT failReserve;
+	struct kPumpDropBuf *bufPool;
+	ULONG nBufs;
+	volatile ULONG currIdx; /* newest pumped buffer + 1, or 0 */
+	volatile ULONG failReserve;
 	BOOL init;
 };
 
 #endif
 
+#if (K_DEF_MSGREF==ON)
+/* Reference-counted message header. The payload follows it. */
+struct kMsgHdr
+{
+	struct kMemBlock *memPtr; /* pool the block returns to */
+	volatile ULONG refCnt;
+} __attribute__((aligned(8)));
+
+#define K_MSG_HDR_SIZE (sizeof(struct kMsgHdr))
+/* block size of a pool for messages of 'size' bytes */
+#define K_MSG_BLK_SIZE(size) (K_MSG_HDR_SIZE + (size))
+#endif
+
+#if (K_DEF_PUBSUB==ON)
+struct kSubscriber
+{
+	struct kSubscriber *nextPtr;
+	struct kTopic *topicPtr; /* topic subscribed to, or NULL */
+	struct kQ *queuePtr; /* messages are delivered here */
+	MSGFILTER filter; /* NULL: every message */
+	ADDR filterArgsPtr;
+	ULONG nDropped; /* messages lost to a full queue */
+};
+
+struct kTopic
+{
+	STRING name;
+	struct kSubscriber *subsPtr; /* list of subscribers */
+	ULONG nSubs;
+	BOOL init;
+};
+#endif
 
 struct kTask
 {
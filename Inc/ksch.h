@@ -40,6 +40,8 @@ K_ERR kReadyCtxtSwtch(K_TCB* const);
 K_ERR kReadyQDeq(K_TCB** const, PRIO);
 K_TCB* kTCBQPeek(K_TCBQ* const);
 K_ERR kTCBQEnqByPrio(K_TCBQ* const, K_TCB* const);
+K_ERR kTCBQJam(K_TCBQ* const, K_TCB* const);
+VOID kTCBSetPrio(K_TCB* const, PRIO const);
 
 /* Doubly Linked List ADT */
 
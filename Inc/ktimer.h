@@ -21,6 +21,10 @@ extern volatile K_TIMEOUT_NODE *timerListHeadPtrSaved;
 K_ERR kTimeOut( K_TIMEOUT_NODE*, TICK);
 BOOL kHandleTimeoutList( VOID);
 VOID kRemoveTimeoutNode( K_TIMEOUT_NODE*);
+/* a time-out node is armed if it has a predecessor or heads the list */
+#define K_TIMEOUT_ARMED(node) \
+	(((node)->prevPtr != NULL) || (timeOutListHeadPtr == (node)))
+K_ERR kTimeOutLeft( K_TIMEOUT_NODE*, TICK64*, TICK);
 extern struct kRunTime runTime; /* record of run time */
 VOID kBusyDelay( TICK const);
 
@@ -31,6 +35,9 @@ VOID kSleep( TICK const);
 #define SLEEP(t) kSleep(t)
 
 TICK kTickGet( VOID);
+TICK64 kTimeNow64( VOID);
+TICK kTimeUntil( TICK64 const);
+VOID kSleepUntilTime( TICK64 const);
 
 #if (K_DEF_SCH_TSLICE==OFF)
 
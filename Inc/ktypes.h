@@ -44,11 +44,13 @@ typedef char *STRING; /*Pointer to string of chars */
 typedef unsigned char PID; /* System defined Task ID type */
 typedef unsigned char PRIO; /* Task priority type */
 typedef unsigned long TICK; /* Tick count type */
+typedef unsigned long long TICK64; /* Monotonic 64-bit tick count type */
 
 /*** Func ptrs typedef */
 typedef void (*TASKENTRY)( void); /* Task entry function pointer */
 typedef void (*CALLOUT)( void*); /* Callout (timers)             */
 typedef void (*CBK)( void*); /* Generic Call Back             */
+typedef BOOL (*MSGFILTER)( void*, void*); /* Message filter (mesg, args) */
 
 /**
  *\brief Return values
@@ -76,6 +78,7 @@ typedef enum kErr
     K_ERR_MUTEX_NOT_LOCKED = 0xE,
     K_ERR_INVALID_PARAM = 0xF,
     K_ERR_EMPTY_WAITING_QUEUE = 0x10,
+    K_ERR_SEQLOCK_BUSY = 0x11, /* an ISR interrupted the writer of a seqlock */
     /* FAULTY RETURN VALUES: negative */
     K_ERROR = ( int) 0xFFFFFFFF, /* (0xFFFFFFFF) Generic error placeholder */
 
@@ -109,7 +112,9 @@ typedef enum kErr
     K_ERR_MUTEX_NOT_OWNER = ( int) 0xFFFF0015,
     K_ERR_TASK_INVALID_ST = ( int) 0xFFFF0016,
     K_ERR_INVALID_ISR_PRIMITIVE = ( int) 0xFFFFF0017,
-    K_ERR_OVERFLOW = ( int) 0xFFFFF0018
+    K_ERR_OVERFLOW = ( int) 0xFFFFF0018,
+    K_ERR_MEM_DOUBLE_FREE = ( int) 0xFFFF0019, /* Block is already free */
+    K_ERR_MEM_FOREIGN = ( int) 0xFFFF001A /* Address is not a block of this pool */
 } K_ERR;
 
 /**
@@ -162,6 +167,30 @@ typedef struct kTimer K_TIMER;
 
 typedef struct kMemBlock K_MEM;
 
+#if (K_DEF_ALLOC_STATS==ON)
+
+typedef struct kMemStats K_MEM_STATS;
+
+#endif
+
+#if (K_DEF_ALLOC_CLASSES==ON)
+
+typedef struct kMemClass K_MEMCLASS;
+
+#endif
+
+#if (K_DEF_ALLOC_ARENA==ON)
+
+typedef struct kArena K_ARENA;
+
+#endif
+
+#endif
+
+#if (K_DEF_HEAP==ON)
+
+typedef struct kHeap K_HEAP;
+
 #endif
 
 typedef struct kList K_LIST;
@@ -181,18 +210,56 @@ typedef struct kStream K_STREAM;
 
 #endif /*mesgq*/
 
+#if (K_DEF_PIPE == ON)
+
+typedef struct kPipe K_PIPE;
+
+#endif
+
+#if (K_DEF_SPSC == ON)
+
+typedef struct kSpsc K_SPSC;
+
+#endif
+
+#if (K_DEF_MPSC == ON)
+
+typedef struct kMpscCell K_MPSC_CELL;
+typedef struct kMpsc K_MPSC;
+
+#endif
+
+#if (K_DEF_BCAST == ON)
+
+typedef struct kBcast K_BCAST;
+typedef struct kBcastReader K_BCAST_READER;
+
+#endif
+
 #if (K_DEF_MBOX == ON)
 
 typedef struct kMailbox K_MBOX;
 
 #endif /* mbox */
 
+#if (K_DEF_CHANNEL == ON)
+
+typedef struct kChannel K_CHANNEL;
+
+#endif
+
 #if (K_DEF_QUEUE==ON)
 
 typedef struct kQ K_QUEUE;
 
 #endif
 
+#if (K_DEF_PQUEUE==ON)
+
+typedef struct kPQueue K_PQUEUE;
+
+#endif
+
 #if (K_DEF_EVENT==ON)
 
 typedef struct kEvent K_EVENT;
@@ -212,4 +279,23 @@ typedef struct kMutex K_MUTEX;
 
 #endif
 
+#if (K_DEF_SEQLOCK == ON)
+
+typedef struct kSeqLock K_SEQLOCK;
+
+#endif
+
+#if (K_DEF_PUBSUB == ON)
+
+typedef struct kTopic K_TOPIC;
+typedef struct kSubscriber K_SUBSCRIBER;
+
+#endif
+
+#if (K_DEF_WAITSET == ON)
+
+typedef struct kWaitSet K_WAIT_SET;
+
+#endif
+
 #endif
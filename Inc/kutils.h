@@ -18,6 +18,72 @@ extern "C" {
 ULONG kStrLen(STRING s);
 ULONG kMemCpy(ADDR destPtr, ADDR const srcPtr, ULONG size);
 
+/*
+ * Copy engine. Buffers that share the same alignment are copied a byte at a
+ * time up to a word boundary, then 4 words per step (LDM/STM), then the
+ * tail. Other buffers are copied by bytes.
+ */
+typedef UINT __attribute__((__may_alias__)) K_WORD;
+
+/* copies nWords 32-bit words between word-aligned buffers */
+__attribute__((always_inline)) static inline VOID kCpyWords(
+		K_WORD *destPtr, K_WORD const *srcPtr, ULONG nWords)
+{
+	while (nWords >= 4)
+	{
+#if defined(__arm__)
+		asm volatile (
+				"ldmia %[s]!, {r2-r5}\n\t"
+				"stmia %[d]!, {r2-r5}"
+				: [d] "+l" (destPtr), [s] "+l" (srcPtr)
+				:
+				: "r2", "r3", "r4", "r5", "memory");
+#else
+		destPtr[0] = srcPtr[0];
+		destPtr[1] = srcPtr[1];
+		destPtr[2] = srcPtr[2];
+		destPtr[3] = srcPtr[3];
+		destPtr += 4;
+		srcPtr += 4;
+#endif
+		nWords -= 4;
+	}
+	while (nWords > 0)
+	{
+		*destPtr++ = *srcPtr++;
+		nWords--;
+	}
+}
+
+/* returns the number of bytes copied */
+__attribute__((always_inline)) static inline ULONG kCpy( ADDR destPtr,
+		ADDR const srcPtr, ULONG const size)
+{
+	BYTE *d = (BYTE*) destPtr;
+	BYTE const *s = (BYTE const*) srcPtr;
+	ULONG n = size;
+	if (((( ULONG) d ^ ( ULONG) s) & (sizeof(K_WORD) - 1)) == 0)
+	{
+		while ((n > 0) && ((( ULONG) d & (sizeof(K_WORD) - 1)) != 0))
+		{
+			*d++ = *s++;
+			n--;
+		}
+		ULONG nWords = n / sizeof(K_WORD);
+		kCpyWords( (K_WORD*) d, (K_WORD const*) s, nWords);
+		d += nWords * sizeof(K_WORD);
+		s += nWords * sizeof(K_WORD);
+		n -= nWords * sizeof(K_WORD);
+	}
+	/* tail */
+	while (n > 0)
+	{
+		*d++ = *s++;
+		n--;
+	}
+	return (size);
+}
+
 #ifdef K_DEF_PRINTF
 
 extern UART_HandleTypeDef huart2;
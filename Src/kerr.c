@@ -34,6 +34,26 @@
 #	error "Invalid minimal effective priority. (Max numerical value: 31)"
 #endif
 
+#if ((K_DEF_MSGREF == ON) && (K_DEF_ALLOC == OFF))
+#	error "Reference-counted messages (K_DEF_MSGREF) require K_DEF_ALLOC"
+#endif
+
+#if ((K_DEF_PUBSUB == ON) && ((K_DEF_MSGREF == OFF) || (K_DEF_QUEUE == OFF)))
+#	error "Publish-subscribe (K_DEF_PUBSUB) requires K_DEF_MSGREF and K_DEF_QUEUE"
+#endif
+
+#if ((K_DEF_PQUEUE == ON) && ((K_DEF_PQUEUE_LEVELS < 1) || (K_DEF_PQUEUE_LEVELS > 32)))
+#	error "Invalid number of mail priorities (K_DEF_PQUEUE_LEVELS: 1 to 32)"
+#endif
+
+#if ((K_DEF_WAITSET == ON) && ((K_DEF_WAITSET_MAX < 1) || (K_DEF_WAITSET_MAX > 32)))
+#	error "Invalid number of wait set items (K_DEF_WAITSET_MAX: 1 to 32)"
+#endif
+
+#if (K_DEF_TICK_PERIOD_US == 0)
+#	error "Invalid tick period in microseconds (K_DEF_TICK_PERIOD_US)"
+#endif
+
 #ifndef SystemCoreClock
 # error "Define SystemCoreClock"
 #endif
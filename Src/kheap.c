@@ -0,0 +1,413 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * 	Module           : TLSF Heap
+ * 	Provides to      : Application
+ * 	Depends on       : Scheduler
+ *  Public API       : Yes
+ * 	In this unit	 :
+ * 					    o Two-Level Segregated Fit variable-size allocator
+ *
+ *  A free block of size s is kept on list [fl][sl]: fl is the power-of-two
+ *  class of s (log2), sl splits each class into K_HEAP_SL_COUNT linear
+ *  ranges. Two bitmaps record the non-empty lists, so both finding a
+ *  suitable block (allocation) and merging with physical neighbours (free)
+ *  take a bounded number of steps, independently of the heap state.
+ *  Allocation rounds the request up to the next list boundary (good-fit),
+ *  which bounds internal fragmentation to 1/K_HEAP_SL_COUNT.
+ *
+ *  Operations are short and bounded, so they run within a critical region
+ *  and can be issued from ISRs.
+ *
+ *****************************************************************************/
+
+#define K_CODE
+#include "kexecutive.h"
+
+#if (K_DEF_HEAP==ON)
+
+#define BLK_FREE_BIT      (0x01UL)
+#define BLK_PREVFREE_BIT  (0x02UL)
+#define BLK_FLAGS         (BLK_FREE_BIT | BLK_PREVFREE_BIT)
+/* header always present: prevPhysPtr and size */
+#define BLK_HDR_SIZE      (offsetof(struct kHeapBlock, nextFreePtr))
+/* a free block must hold its free-list links */
+#define BLK_MIN_SIZE      (sizeof(struct kHeapBlock) - BLK_HDR_SIZE)
+#define BLK_MAX_SIZE      ((1UL << K_DEF_HEAP_FL_MAX) - K_HEAP_ALIGN)
+#define SMALL_BLK_SIZE    (1UL << K_HEAP_FL_SHIFT)
+#define ALIGN_UP(x)       (((x) + (K_HEAP_ALIGN - 1)) & ~(K_HEAP_ALIGN - 1))
+
+typedef struct kHeapBlock K_HEAP_BLOCK;
+
+/*******************************************************************************
+ * BLOCK HELPERS
+ *******************************************************************************/
+
+/* index of the most significant bit set (x > 0) */
+static inline ULONG kHeapFls_( ULONG const x)
+{
+	return ((8 * sizeof(UINT) - 1) - __builtin_clz( ( UINT) x));
+}
+
+/* index of the least significant bit set (x > 0) */
+static inline ULONG kHeapFfs_( ULONG const x)
+{
+	return (__builtin_ctz( ( UINT) x));
+}
+
+static inline ULONG kBlkSize_( K_HEAP_BLOCK const *blkPtr)
+{
+	return (blkPtr->size & ~BLK_FLAGS);
+}
+
+static inline VOID kBlkSetSize_( K_HEAP_BLOCK *blkPtr, ULONG const size)
+{
+	blkPtr->size = size | (blkPtr->size & BLK_FLAGS);
+}
+
+static inline BOOL kBlkIsFree_( K_HEAP_BLOCK const *blkPtr)
+{
+	return ((blkPtr->size & BLK_FREE_BIT) ? TRUE : FALSE);
+}
+
+static inline BOOL kBlkIsPrevFree_( K_HEAP_BLOCK const *blkPtr)
+{
+	return ((blkPtr->size & BLK_PREVFREE_BIT) ? TRUE : FALSE);
+}
+
+static inline ADDR kBlkToPtr_( K_HEAP_BLOCK *blkPtr)
+{
+	return ((BYTE*) blkPtr + BLK_HDR_SIZE);
+}
+
+static inline K_HEAP_BLOCK* kBlkFromPtr_( ADDR ptr)
+{
+	return ((K_HEAP_BLOCK*) ((BYTE*) ptr - BLK_HDR_SIZE));
+}
+
+static inline K_HEAP_BLOCK* kBlkNext_( K_HEAP_BLOCK *blkPtr)
+{
+	return ((K_HEAP_BLOCK*) ((BYTE*) blkPtr + BLK_HDR_SIZE
+			+ kBlkSize_( blkPtr)));
+}
+
+/* flags the block as free and tells its physical successor */
+static inline VOID kBlkMarkFree_( K_HEAP_BLOCK *blkPtr)
+{
+	K_HEAP_BLOCK *nextPtr = kBlkNext_( blkPtr);
+	blkPtr->size |= BLK_FREE_BIT;
+	nextPtr->prevPhysPtr = blkPtr;
+	nextPtr->size |= BLK_PREVFREE_BIT;
+}
+
+static inline VOID kBlkMarkUsed_( K_HEAP_BLOCK *blkPtr)
+{
+	K_HEAP_BLOCK *nextPtr = kBlkNext_( blkPtr);
+	blkPtr->size &= ~BLK_FREE_BIT;
+	nextPtr->size &= ~BLK_PREVFREE_BIT;
+}
+
+/*******************************************************************************
+ * SIZE MAPPING AND FREE LISTS
+ *******************************************************************************/
+
+static inline VOID kHeapMapping_( ULONG const size, ULONG *flPtr, ULONG *slPtr)
+{
+	if (size < SMALL_BLK_SIZE)
+	{
+		*flPtr = 0;
+		*slPtr = size / (SMALL_BLK_SIZE / K_HEAP_SL_COUNT);
+	}
+	else
+	{
+		ULONG fl = kHeapFls_( size);
+		*slPtr = (size >> (fl - K_DEF_HEAP_SL_LOG2))
+				^ (1UL << K_DEF_HEAP_SL_LOG2);
+		*flPtr = fl - (K_HEAP_FL_SHIFT - 1);
+	}
+}
+
+/* rounds the size up to the next list, so any block found there fits */
+static inline VOID kHeapMappingSearch_( ULONG size, ULONG *flPtr,
+		ULONG *slPtr)
+{
+	if (size >= SMALL_BLK_SIZE)
+	{
+		size += (1UL << (kHeapFls_( size) - K_DEF_HEAP_SL_LOG2)) - 1;
+	}
+	kHeapMapping_( size, flPtr, slPtr);
+}
+
+static inline VOID kHeapInsertFree_( K_HEAP *const kobj, K_HEAP_BLOCK *blkPtr)
+{
+	ULONG fl, sl;
+	kHeapMapping_( kBlkSize_( blkPtr), &fl, &sl);
+	K_HEAP_BLOCK *headPtr = kobj->freeLists[fl][sl];
+	blkPtr->prevFreePtr = NULL;
+	blkPtr->nextFreePtr = headPtr;
+	if (headPtr != NULL)
+	{
+		headPtr->prevFreePtr = blkPtr;
+	}
+	kobj->freeLists[fl][sl] = blkPtr;
+	kobj->flBitmap |= (1UL << fl);
+	kobj->slBitmap[fl] |= (1UL << sl);
+	kobj->nFreeBytes += kBlkSize_( blkPtr);
+}
+
+static inline VOID kHeapRemoveFree_( K_HEAP *const kobj, K_HEAP_BLOCK *blkPtr)
+{
+	ULONG fl, sl;
+	kHeapMapping_( kBlkSize_( blkPtr), &fl, &sl);
+	if (blkPtr->prevFreePtr != NULL)
+	{
+		blkPtr->prevFreePtr->nextFreePtr = blkPtr->nextFreePtr;
+	}
+	else
+	{
+		kobj->freeLists[fl][sl] = blkPtr->nextFreePtr;
+	}
+	if (blkPtr->nextFreePtr != NULL)
+	{
+		blkPtr->nextFreePtr->prevFreePtr = blkPtr->prevFreePtr;
+	}
+	if (kobj->freeLists[fl][sl] == NULL)
+	{
+		kobj->slBitmap[fl] &= ~(1UL << sl);
+		if (kobj->slBitmap[fl] == 0)
+		{
+			kobj->flBitmap &= ~(1UL << fl);
+		}
+	}
+	kobj->nFreeBytes -= kBlkSize_( blkPtr);
+}
+
+/* first non-empty list at or above [fl][sl] */
+static inline K_HEAP_BLOCK* kHeapFindSuitable_( K_HEAP *const kobj, ULONG fl,
+		ULONG sl)
+{
+	ULONG slMap = kobj->slBitmap[fl] & (~0UL << sl);
+	if (slMap == 0)
+	{
+		ULONG flMap = kobj->flBitmap & (~0UL << (fl + 1));
+		if (flMap == 0)
+		{
+			return (NULL);
+		}
+		fl = kHeapFfs_( flMap);
+		slMap = kobj->slBitmap[fl];
+	}
+	sl = kHeapFfs_( slMap);
+	return (kobj->freeLists[fl][sl]);
+}
+
+/*******************************************************************************
+ * PUBLIC METHODS
+ *******************************************************************************/
+
+K_ERR kHeapInit( K_HEAP *const kobj, ADDR const memPtr, ULONG const memSize)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( memPtr))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_MEM_INIT);
+	}
+	BYTE *startPtr = (BYTE*) ALIGN_UP( ( ULONG) memPtr);
+	BYTE *endPtr = (BYTE*) (( ULONG) ((BYTE*) memPtr + memSize)
+			& ~(K_HEAP_ALIGN - 1));
+	/* one block and the end sentinel */
+	if ((endPtr <= startPtr)
+			|| (( ULONG) (endPtr - startPtr)
+					< (2 * BLK_HDR_SIZE + BLK_MIN_SIZE)))
+	{
+		return (K_ERR_MEM_INIT);
+	}
+	ULONG size = ( ULONG) (endPtr - startPtr) - 2 * BLK_HDR_SIZE;
+	if (size > BLK_MAX_SIZE)
+	{
+		/* what is left is not managed */
+		size = BLK_MAX_SIZE;
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->flBitmap = 0;
+	for (ULONG fl = 0; fl < K_HEAP_FL_COUNT; ++fl)
+	{
+		kobj->slBitmap[fl] = 0;
+		for (ULONG sl = 0; sl < K_HEAP_SL_COUNT; ++sl)
+		{
+			kobj->freeLists[fl][sl] = NULL;
+		}
+	}
+	kobj->nFreeBytes = 0;
+	K_HEAP_BLOCK *blkPtr = (K_HEAP_BLOCK*) startPtr;
+	blkPtr->prevPhysPtr = NULL;
+	blkPtr->size = size;
+	/* zero-sized used sentinel: merging never crosses the heap end */
+	K_HEAP_BLOCK *sentinelPtr = kBlkNext_( blkPtr);
+	sentinelPtr->size = 0;
+	kBlkMarkFree_( blkPtr);
+	kHeapInsertFree_( kobj, blkPtr);
+	kobj->firstBlockPtr = blkPtr;
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+ADDR kHeapAlloc( K_HEAP *const kobj, ULONG const size)
+{
+	if (IS_NULL_PTR( kobj) || (kobj->init == FALSE))
+	{
+		return (NULL);
+	}
+	if ((size == 0) || (size > BLK_MAX_SIZE))
+	{
+		return (NULL);
+	}
+	ULONG adjSize = ALIGN_UP( size);
+	if (adjSize < BLK_MIN_SIZE)
+	{
+		adjSize = BLK_MIN_SIZE;
+	}
+	ULONG fl, sl;
+	kHeapMappingSearch_( adjSize, &fl, &sl);
+	if (fl >= K_HEAP_FL_COUNT)
+	{
+		return (NULL);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	K_HEAP_BLOCK *blkPtr = kHeapFindSuitable_( kobj, fl, sl);
+	if (blkPtr == NULL)
+	{
+		K_CR_EXIT
+		return (NULL);
+	}
+	kassert( kBlkIsFree_( blkPtr) && (kBlkSize_( blkPtr) >= adjSize));
+	kHeapRemoveFree_( kobj, blkPtr);
+	/* split if the remainder can be a block on its own */
+	if (kBlkSize_( blkPtr) >= (adjSize + BLK_HDR_SIZE + BLK_MIN_SIZE))
+	{
+		K_HEAP_BLOCK *remPtr = (K_HEAP_BLOCK*) ((BYTE*) kBlkToPtr_( blkPtr)
+				+ adjSize);
+		remPtr->size = kBlkSize_( blkPtr) - adjSize - BLK_HDR_SIZE;
+		kBlkSetSize_( blkPtr, adjSize);
+		remPtr->prevPhysPtr = blkPtr;
+		kBlkMarkFree_( remPtr);
+		kHeapInsertFree_( kobj, remPtr);
+	}
+	kBlkMarkUsed_( blkPtr);
+	K_CR_EXIT
+	return (kBlkToPtr_( blkPtr));
+}
+
+K_ERR kHeapFree( K_HEAP *const kobj, ADDR const ptr)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( ptr) || (kobj->init == FALSE))
+	{
+		return (K_ERR_MEM_FREE);
+	}
+	K_HEAP_BLOCK *blkPtr = kBlkFromPtr_( ptr);
+	K_CR_AREA
+	K_CR_ENTER
+	if (kBlkIsFree_( blkPtr))
+	{
+		/* double free */
+		kassert( 0);
+		K_CR_EXIT
+		return (K_ERR_MEM_FREE);
+	}
+	/* merge with the next physical block */
+	K_HEAP_BLOCK *nextPtr = kBlkNext_( blkPtr);
+	if (kBlkIsFree_( nextPtr))
+	{
+		kHeapRemoveFree_( kobj, nextPtr);
+		kBlkSetSize_( blkPtr,
+				kBlkSize_( blkPtr) + BLK_HDR_SIZE + kBlkSize_( nextPtr));
+	}
+	/* merge with the previous physical block */
+	if (kBlkIsPrevFree_( blkPtr))
+	{
+		K_HEAP_BLOCK *prevPtr = blkPtr->prevPhysPtr;
+		kassert( kBlkIsFree_( prevPtr));
+		kHeapRemoveFree_( kobj, prevPtr);
+		kBlkSetSize_( prevPtr,
+				kBlkSize_( prevPtr) + BLK_HDR_SIZE + kBlkSize_( blkPtr));
+		blkPtr = prevPtr;
+	}
+	kBlkMarkFree_( blkPtr);
+	kHeapInsertFree_( kobj, blkPtr);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+ULONG kHeapFreeBytes( K_HEAP *const kobj)
+{
+	return (kobj->nFreeBytes);
+}
+
+#ifndef NDEBUG
+/*
+ * Walks the physical blocks and the free lists and checks they agree:
+ * no two adjacent free blocks, consistent previous-free flags and back
+ * links, and every free block on the list its size maps to.
+ * It is O(n) - meant for debugging, not for production paths.
+ */
+K_ERR kHeapCheck( K_HEAP *const kobj)
+{
+	K_ERR err = K_SUCCESS;
+	ULONG nFree = 0;
+	ULONG nFreeBytes = 0;
+	K_CR_AREA
+	K_CR_ENTER
+	K_HEAP_BLOCK *prevPtr = NULL;
+	K_HEAP_BLOCK *blkPtr = kobj->firstBlockPtr;
+	while (kBlkSize_( blkPtr) != 0)
+	{
+		BOOL prevFree = (prevPtr != NULL) && kBlkIsFree_( prevPtr);
+		if (kBlkIsPrevFree_( blkPtr) != prevFree)
+			err = K_ERROR;
+		if (prevFree && (blkPtr->prevPhysPtr != prevPtr))
+			err = K_ERROR;
+		if (prevFree && kBlkIsFree_( blkPtr))
+			err = K_ERROR; /* not merged */
+		if (kBlkIsFree_( blkPtr))
+		{
+			nFree++;
+			nFreeBytes += kBlkSize_( blkPtr);
+		}
+		prevPtr = blkPtr;
+		blkPtr = kBlkNext_( blkPtr);
+	}
+	for (ULONG fl = 0; fl < K_HEAP_FL_COUNT; ++fl)
+	{
+		for (ULONG sl = 0; sl < K_HEAP_SL_COUNT; ++sl)
+		{
+			K_HEAP_BLOCK *freePtr = kobj->freeLists[fl][sl];
+			BOOL bit = (kobj->slBitmap[fl] & (1UL << sl)) ? TRUE : FALSE;
+			if (bit != (freePtr != NULL))
+				err = K_ERROR;
+			while (freePtr != NULL)
+			{
+				ULONG f, s;
+				kHeapMapping_( kBlkSize_( freePtr), &f, &s);
+				if ((f != fl) || (s != sl) || !kBlkIsFree_( freePtr))
+					err = K_ERROR;
+				nFree--;
+				freePtr = freePtr->nextFreePtr;
+			}
+		}
+		if (((kobj->flBitmap & (1UL << fl)) != 0) != (kobj->slBitmap[fl] != 0))
+			err = K_ERROR;
+	}
+	if ((nFree != 0) || (nFreeBytes != kobj->nFreeBytes))
+		err = K_ERROR;
+	K_CR_EXIT
+	return (err);
+}
+#endif
+
+#endif /* K_DEF_HEAP */
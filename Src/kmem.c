@@ -10,6 +10,8 @@
  *  Public API       : Yes
  * 	In this unit	 :
  * 					    o Memory Block Allocator
+ * 					    o Size-Class Allocator
+ * 					    o Arena Allocator
  *
  *****************************************************************************/
 
@@ -19,92 +21,933 @@
 
 #if (K_DEF_ALLOC==ON)
 
-K_ERR kMemInit( K_MEM *const kobj, ADDR const memPoolPtr, BYTE blkSize,
-		BYTE const numBlocks)
+/*
+ * Free list is built lazily: blocks never handed out are taken from a bump
+ * pointer, so initialising a pool is O(1) regardless of its size. Freed
+ * blocks are linked on the free list, which has precedence over the bump
+ * pointer.
+ */
+
+#if (K_MEM_LOCKFREE==ON)
+/*
+ * Lock-free free list. Blocks are linked by index so the head fits a single
+ * word together with an ABA tag, bumped on every update: a pop that read a
+ * head which was popped and pushed back meanwhile fails the CAS instead of
+ * installing a stale 'next'.
+ */
+#define MEM_IDX_MASK  (0xFFFFUL)
+#define MEM_TAG_INC   (0x10000UL)
+#define MEM_LF_MAX_BLOCKS (0xFFFFUL)
+
+static inline ADDR kMemPop_( K_MEM *const kobj)
+{
+	ULONG head, next;
+	BYTE *blkPtr;
+	do
+	{
+		head = kobj->freeHead;
+		ULONG idx = head & MEM_IDX_MASK;
+		if (idx == 0)
+		{
+			/* free list is empty: take a never-used block */
+			ULONG bump;
+			do
+			{
+				bump = kobj->bumpIdx;
+				if (bump >= kobj->nMaxBlocks)
+				{
+					return (NULL);
+				}
+			} while (!kAtomicCAS( &kobj->bumpIdx, bump, bump + 1));
+			return (kobj->poolPtr + (bump * kobj->blkSize));
+		}
+		blkPtr = kobj->poolPtr + ((idx - 1) * kobj->blkSize);
+		next = ((head + MEM_TAG_INC) & ~MEM_IDX_MASK)
+				| (*(volatile ULONG*) blkPtr & MEM_IDX_MASK);
+	} while (!kAtomicCAS( &kobj->freeHead, head, next));
+	return (blkPtr);
+}
+
+static inline VOID kMemPush_( K_MEM *const kobj, ADDR const blockPtr)
+{
+	ULONG idx = ((( BYTE*) blockPtr - kobj->poolPtr) / kobj->blkSize) + 1;
+	ULONG head;
+	do
+	{
+		head = kobj->freeHead;
+		*(volatile ULONG*) blockPtr = head & MEM_IDX_MASK;
+	} while (!kAtomicCAS( &kobj->freeHead, head,
+			((head + MEM_TAG_INC) & ~MEM_IDX_MASK) | idx));
+}
+
+/* links a block to the next one of a chain being freed (NULL ends it) */
+static inline VOID kMemLink_( K_MEM *const kobj, ADDR const blockPtr,
+		ADDR const nextPtr)
+{
+	*(volatile ULONG*) blockPtr = (nextPtr == NULL) ? 0 :
+			((( BYTE*) nextPtr - kobj->poolPtr) / kobj->blkSize) + 1;
+}
+
+/* splices a linked chain with a single CAS */
+static inline VOID kMemPushChain_( K_MEM *const kobj, ADDR const firstPtr,
+		ADDR const lastPtr)
+{
+	ULONG idx = ((( BYTE*) firstPtr - kobj->poolPtr) / kobj->blkSize) + 1;
+	ULONG head;
+	do
+	{
+		head = kobj->freeHead;
+		*(volatile ULONG*) lastPtr = head & MEM_IDX_MASK;
+	} while (!kAtomicCAS( &kobj->freeHead, head,
+			((head + MEM_TAG_INC) & ~MEM_IDX_MASK) | idx));
+}
+
+#else
+/* within a critical region */
+static inline ADDR kMemPop_( K_MEM *const kobj)
+{
+	ADDR allocPtr = kobj->freeListPtr;
+	if (allocPtr != NULL)
+	{
+		kobj->freeListPtr = *(ADDR*) allocPtr;
+	}
+	else if (kobj->nBumpBlocks > 0)
+	{
+		/* never-used block */
+		allocPtr = kobj->bumpPtr;
+		kobj->bumpPtr += kobj->blkSize;
+		kobj->nBumpBlocks -= 1;
+	}
+	return (allocPtr);
+}
+
+static inline VOID kMemPush_( K_MEM *const kobj, ADDR const blockPtr)
+{
+	*(ADDR*) blockPtr = kobj->freeListPtr;
+	kobj->freeListPtr = blockPtr;
+}
+
+static inline VOID kMemLink_( K_MEM *const kobj, ADDR const blockPtr,
+		ADDR const nextPtr)
+{
+	(void) kobj;
+	*(ADDR*) blockPtr = nextPtr;
+}
+
+static inline VOID kMemPushChain_( K_MEM *const kobj, ADDR const firstPtr,
+		ADDR const lastPtr)
+{
+	*(ADDR*) lastPtr = kobj->freeListPtr;
+	kobj->freeListPtr = firstPtr;
+}
+#endif
+
+K_ERR kMemInit( K_MEM *const kobj, ADDR const memPoolPtr, ULONG blkSize,
+		ULONG const numBlocks)
 {
 	K_CR_AREA
 
 	K_CR_ENTER
 
-	if (IS_NULL_PTR( kobj))
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( memPoolPtr))
 	{
 		KFAULT( FAULT_OBJ_NULL);
 		K_CR_EXIT
 		return (K_ERR_MEM_INIT);
 	}
-	/*round up to next value multiple of 4 (if not a multiple)*/
-	blkSize = (blkSize + 0x03) & 0xFC;
-
-	/* initialise freelist of blocks */
-
-	BYTE *blockPtr = (BYTE*) memPoolPtr; /* first byte address in the pool  */
-	ADDR *nextAddrPtr = (ADDR*) memPoolPtr; /* next block address */
-
-	for (BYTE i = 0; i < numBlocks - 1; i++)
+	if ((blkSize == 0) || (numBlocks == 0))
 	{
-		/* init pool by advancing each block addr by blkSize bytes */
-		blockPtr += blkSize;
-		/* save blockPtr addr as the next */
-		*nextAddrPtr = (ADDR) blockPtr;
-		/* update  */
-		nextAddrPtr = (ADDR*) (blockPtr);
-
+		K_CR_EXIT
+		return (K_ERR_MEM_INIT);
+	}
+#if (K_MEM_LOCKFREE==ON)
+	if (numBlocks > MEM_LF_MAX_BLOCKS)
+	{
+		K_CR_EXIT
+		return (K_ERR_MEM_INIT);
 	}
-	*nextAddrPtr = NULL;
+#endif
+	/*round up to next value multiple of 4 (if not a multiple)*/
+	blkSize = (blkSize + 0x03) & ~0x03UL;
 
 	/* init the control block */
 	kobj->blkSize = blkSize;
 	kobj->nMaxBlocks = numBlocks;
 	kobj->nFreeBlocks = numBlocks;
-	kobj->freeListPtr = memPoolPtr;
 	kobj->poolPtr = memPoolPtr;
-#if(MEMBLKLAST)
-    kobj->lastUsed = NULL;
+#if (K_MEM_LOCKFREE==ON)
+	kobj->freeHead = 0;
+	kobj->bumpIdx = 0;
+#else
+	kobj->freeListPtr = NULL;
+	kobj->bumpPtr = memPoolPtr;
+	kobj->nBumpBlocks = numBlocks;
+#endif
+#if (K_DEF_ALLOC_STATS==ON)
+	kobj->minFreeBlocks = numBlocks;
+	kobj->nAllocs = 0;
+	kobj->nAllocFails = 0;
+	kobj->rateAllocs = 0;
+	kobj->rateTick = kTimeNow64();
+	kobj->lowMark = 0;
+	kobj->lowMarkCbk = NULL;
+	kobj->lowMarkArgsPtr = NULL;
+#endif
+#if (K_DEF_ALLOC_CHECK==ON)
+	kobj->allocMapPtr = NULL;
+#endif
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+	K_ERR listerr = kListInit( &kobj->waitingQueue, "memq");
+	kassert( listerr == 0);
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.objectType = MEMPOOL;
 #endif
 	kobj->init = TRUE;
 	K_CR_EXIT
 	return (K_SUCCESS);
 }
 
-ADDR kMemAlloc( K_MEM *const kobj)
+#if (K_DEF_ALLOC_CHECK==ON)
+/* index of a block of this pool, or nMaxBlocks if it is not one */
+static inline ULONG kMemBlockIdx_( K_MEM const *const kobj,
+		ADDR const blockPtr)
 {
+	BYTE *endPtr = kobj->poolPtr + (kobj->blkSize * kobj->nMaxBlocks);
+	if ((( BYTE*) blockPtr < kobj->poolPtr) || (( BYTE*) blockPtr >= endPtr))
+	{
+		return (kobj->nMaxBlocks);
+	}
+	ULONG offset = ( ULONG) (( BYTE*) blockPtr - kobj->poolPtr);
+	if ((offset % kobj->blkSize) != 0)
+	{
+		return (kobj->nMaxBlocks);
+	}
+	return (offset / kobj->blkSize);
+}
 
-	if (kobj->nFreeBlocks == 0)
+/* sets (or clears) the bit of a block; returns its previous value */
+static inline BOOL kMemMapUpdate_( K_MEM *const kobj, ULONG const idx,
+		BOOL const set)
+{
+	volatile ULONG *wordPtr = &kobj->allocMapPtr[idx / (8 * sizeof(ULONG))];
+	ULONG mask = 1UL << (idx % (8 * sizeof(ULONG)));
+	ULONG word;
+	do
 	{
-		return (NULL);
+		word = *wordPtr;
+	} while (!kAtomicCAS( wordPtr, word, set ? (word | mask) : (word & ~mask)));
+	return ((word & mask) != 0);
+}
+#endif
+
+#if ((K_DEF_ALLOC_STATS==ON) || (K_DEF_ALLOC_CHECK==ON))
+/* bookkeeping after an allocation attempt; nFree is the count it left */
+static inline VOID kMemOnAlloc_( K_MEM *const kobj, ADDR const allocPtr,
+		ULONG const nFree)
+{
+	if (allocPtr == NULL)
+	{
+#if (K_DEF_ALLOC_STATS==ON)
+		kAtomicAdd( &kobj->nAllocFails, 1);
+#endif
+		return;
+	}
+#if (K_DEF_ALLOC_CHECK==ON)
+	if (kobj->allocMapPtr != NULL)
+	{
+		BOOL wasSet = kMemMapUpdate_( kobj, kMemBlockIdx_( kobj, allocPtr),
+				TRUE);
+		/* free list is corrupted */
+		kassert( wasSet == FALSE);
+		(void) wasSet;
+	}
+#endif
+#if (K_DEF_ALLOC_STATS==ON)
+	kAtomicAdd( &kobj->nAllocs, 1);
+	ULONG minFree;
+	do
+	{
+		minFree = kobj->minFreeBlocks;
+		if (nFree >= minFree)
+		{
+			break;
+		}
+	} while (!kAtomicCAS( &kobj->minFreeBlocks, minFree, nFree));
+	/* a single allocation leaves exactly lowMark blocks: once per crossing */
+	if ((kobj->lowMarkCbk != NULL) && (nFree == kobj->lowMark))
+	{
+		kobj->lowMarkCbk( kobj->lowMarkArgsPtr);
 	}
+#else
+	(void) nFree;
+#endif
+}
+#endif
+
+ADDR kMemAlloc( K_MEM *const kobj)
+{
+	ULONG nFree = 0;
+#if (K_MEM_LOCKFREE==ON)
+	ADDR allocPtr = kMemPop_( kobj);
+	if (allocPtr != NULL)
+		nFree = ( ULONG) kAtomicAdd( &kobj->nFreeBlocks, -1);
+#else
+	ADDR allocPtr = NULL;
 	K_CR_AREA
 
 	K_CR_ENTER
-	ADDR allocPtr = kobj->freeListPtr;
-	kobj->freeListPtr = *(ADDR*) allocPtr;
-#if(MEMBLKLAST)
-    kobj->lastUsed = allocPtr;
-    #endif
+	if (kobj->nFreeBlocks > 0)
+	{
+		allocPtr = kMemPop_( kobj);
+	}
 	if (allocPtr != NULL)
 		kobj->nFreeBlocks -= 1;
+	nFree = kobj->nFreeBlocks;
 	K_CR_EXIT
+#endif
+#if ((K_DEF_ALLOC_STATS==ON) || (K_DEF_ALLOC_CHECK==ON))
+	kMemOnAlloc_( kobj, allocPtr, nFree);
+#else
+	(void) nFree;
+#endif
 	return (allocPtr);
 }
 
-K_ERR kMemFree( K_MEM *const kobj, ADDR const blockPtr)
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+/* pool has waiters: hand blocks over, highest priority first */
+static inline VOID kMemHandOver_( K_MEM *const kobj)
 {
+	while (kobj->waitingQueue.size > 0)
+	{
+		ADDR blockPtr = kMemAlloc( kobj);
+		if (blockPtr == NULL)
+		{
+			break;
+		}
+		K_TCB *freeTaskPtr;
+		kTCBQDeq( &kobj->waitingQueue, &freeTaskPtr);
+		kassert( freeTaskPtr != NULL);
+		freeTaskPtr->xferPtr = blockPtr;
+		kReadyCtxtSwtch( freeTaskPtr);
+	}
+}
+#endif
 
-	if (kobj->nFreeBlocks == kobj->nMaxBlocks)
+/* returns a chain of n linked blocks, first to last, to the pool */
+static K_ERR kMemSplice_( K_MEM *const kobj, ADDR const firstPtr,
+		ADDR const lastPtr, ULONG const n)
+{
+#if (K_MEM_LOCKFREE==ON)
+	/* a block is counted after it is pushed and popped before it is
+	 * uncounted, so the count can dip below 0 for a moment */
+	if ((( LONG) kobj->nFreeBlocks + ( LONG) n) > ( LONG) kobj->nMaxBlocks)
 	{
 		return (K_ERR_MEM_FREE);
 	}
+	kMemPushChain_( kobj, firstPtr, lastPtr);
+	kAtomicAdd( &kobj->nFreeBlocks, ( long) n);
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+	/* a waiter enqueues atomically with its last failed attempt, so
+	 * if it is not seen here, that attempt has seen these blocks */
+	if (kobj->waitingQueue.size > 0)
+	{
+		K_CR_AREA
+		K_CR_ENTER
+		kMemHandOver_( kobj);
+		K_CR_EXIT
+	}
+#endif
+	return (K_SUCCESS);
+#else
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj->nFreeBlocks + n) > kobj->nMaxBlocks)
+	{
+		K_CR_EXIT
+		return (K_ERR_MEM_FREE);
+	}
+	kMemPushChain_( kobj, firstPtr, lastPtr);
+	kobj->nFreeBlocks += n;
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+	/* pool was empty and there are waiters: hand the blocks over */
+	kMemHandOver_( kobj);
+#endif
+	K_CR_EXIT
+	return (K_SUCCESS);
+#endif
+}
+
+#if (K_DEF_ALLOC_CHECK==ON)
+/* rejects foreign blocks and double frees; marks the block free */
+static inline K_ERR kMemCheckFree_( K_MEM *const kobj, ADDR const blockPtr)
+{
+	ULONG idx = kMemBlockIdx_( kobj, blockPtr);
+	if (idx == kobj->nMaxBlocks)
+	{
+		return (K_ERR_MEM_FOREIGN);
+	}
+	if ((kobj->allocMapPtr != NULL)
+			&& (kMemMapUpdate_( kobj, idx, FALSE) == FALSE))
+	{
+		return (K_ERR_MEM_DOUBLE_FREE);
+	}
+	return (K_SUCCESS);
+}
+
+/* undoes kMemCheckFree_() when a batch is rejected */
+static inline VOID kMemUncheckFree_( K_MEM *const kobj, ADDR const blockPtr)
+{
+	if (kobj->allocMapPtr != NULL)
+	{
+		kMemMapUpdate_( kobj, kMemBlockIdx_( kobj, blockPtr), TRUE);
+	}
+}
+#endif
+
+K_ERR kMemFree( K_MEM *const kobj, ADDR const blockPtr)
+{
 	if (IS_NULL_PTR(kobj) || IS_NULL_PTR( blockPtr))
 	{
 		return (K_ERR_MEM_FREE);
 	}
+#if (K_DEF_ALLOC_CHECK==ON)
+	K_ERR err = kMemCheckFree_( kobj, blockPtr);
+	if (err != K_SUCCESS)
+	{
+		return (err);
+	}
+#endif
+	return (kMemSplice_( kobj, blockPtr, blockPtr, 1));
+}
+
+/* Batch allocation: takes up to n blocks within a single critical region
+ * (or, lock-free, with a single counter update).
+ */
+ULONG kMemAllocN( K_MEM *const kobj, ADDR *const ptrs, ULONG const n)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( ptrs))
+	{
+		return (0);
+	}
+	ULONG nGot = 0;
+	ULONG nFree = 0;
+#if (K_MEM_LOCKFREE==ON)
+	while (nGot < n)
+	{
+		ADDR allocPtr = kMemPop_( kobj);
+		if (allocPtr == NULL)
+		{
+			break;
+		}
+		ptrs[nGot++] = allocPtr;
+	}
+	if (nGot > 0)
+		nFree = ( ULONG) kAtomicAdd( &kobj->nFreeBlocks, -( long) nGot);
+#else
 	K_CR_AREA
 	K_CR_ENTER
-	*(ADDR*) blockPtr = kobj->freeListPtr;
-	kobj->freeListPtr = blockPtr;
-	kobj->nFreeBlocks += 1;
+	while ((nGot < n) && (nGot < kobj->nFreeBlocks))
+	{
+		ptrs[nGot++] = kMemPop_( kobj);
+	}
+	kobj->nFreeBlocks -= nGot;
+	nFree = kobj->nFreeBlocks;
+	K_CR_EXIT
+#endif
+#if ((K_DEF_ALLOC_STATS==ON) || (K_DEF_ALLOC_CHECK==ON))
+	for (ULONG i = 0; i < nGot; ++i)
+	{
+		kMemOnAlloc_( kobj, ptrs[i], nFree + (nGot - 1 - i));
+	}
+	if (nGot < n)
+	{
+		kMemOnAlloc_( kobj, NULL, nFree);
+	}
+#else
+	(void) nFree;
+#endif
+	return (nGot);
+}
+
+/* Batch free: the blocks are linked outside the critical region and
+ * spliced onto the free list at once.
+ */
+K_ERR kMemFreeN( K_MEM *const kobj, ADDR *const ptrs, ULONG const n)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( ptrs) || (n == 0))
+	{
+		return (K_ERR_MEM_FREE);
+	}
+	for (ULONG i = 0; i < n; ++i)
+	{
+		if (IS_NULL_PTR( ptrs[i]))
+		{
+			return (K_ERR_MEM_FREE);
+		}
+	}
+#if (K_DEF_ALLOC_CHECK==ON)
+	for (ULONG i = 0; i < n; ++i)
+	{
+		K_ERR err = kMemCheckFree_( kobj, ptrs[i]);
+		if (err != K_SUCCESS)
+		{
+			while (i-- > 0)
+			{
+				kMemUncheckFree_( kobj, ptrs[i]);
+			}
+			return (err);
+		}
+	}
+#endif
+	for (ULONG i = 0; i < (n - 1); ++i)
+	{
+		kMemLink_( kobj, ptrs[i], ptrs[i + 1]);
+	}
+	return (kMemSplice_( kobj, ptrs[0], ptrs[n - 1], n));
+}
+
+/* Frees a NULL-terminated chain of blocks linked through their first word
+ * (e.g., a list of descriptors already kept by the caller).
+ */
+K_ERR kMemFreeChain( K_MEM *const kobj, ADDR const headPtr)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( headPtr))
+	{
+		return (K_ERR_MEM_FREE);
+	}
+	ULONG n = 0;
+	ADDR blkPtr = headPtr;
+	ADDR lastPtr = NULL;
+	K_ERR err = K_SUCCESS;
+	while ((blkPtr != NULL) && (err == K_SUCCESS))
+	{
+		/* longer than the pool: not a chain of this pool */
+		if (n == kobj->nMaxBlocks)
+		{
+			err = K_ERR_MEM_FREE;
+			break;
+		}
+#if (K_DEF_ALLOC_CHECK==ON)
+		err = kMemCheckFree_( kobj, blkPtr);
+		if (err != K_SUCCESS)
+		{
+			break;
+		}
+#endif
+		lastPtr = blkPtr;
+		blkPtr = *(ADDR*) blkPtr;
+		n++;
+	}
+	if (err != K_SUCCESS)
+	{
+#if (K_DEF_ALLOC_CHECK==ON)
+		for (ADDR undoPtr = headPtr; n > 0; --n)
+		{
+			kMemUncheckFree_( kobj, undoPtr);
+			undoPtr = *(ADDR*) undoPtr;
+		}
+#endif
+		return (err);
+	}
+	/* lock-free pools link blocks by index */
+	for (blkPtr = headPtr; blkPtr != lastPtr;)
+	{
+		ADDR nextPtr = *(ADDR*) blkPtr;
+		kMemLink_( kobj, blkPtr, nextPtr);
+		blkPtr = nextPtr;
+	}
+	return (kMemSplice_( kobj, headPtr, lastPtr, n));
+}
+
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+/* Blocking allocation. The waiting queue is ordered by priority and
+ * kMemFree() hands blocks over to waiters before anyone else can take
+ * them, so a task woken up always has its block. Cannot block within
+ * an ISR.
+ */
+ADDR kMemAllocWait( K_MEM *const kobj, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	if (IS_NULL_PTR( kobj))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (NULL);
+	}
+	if (kobj->init == FALSE)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (NULL);
+	}
+	ADDR allocPtr = kMemAlloc( kobj);
+	if ((allocPtr == NULL) && (timeout != K_NO_WAIT))
+	{
+		runPtr->xferPtr = NULL;
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+		runPtr->status = BLOCKED;
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+			kTimeOut( &kobj->timeoutNode, timeout);
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (NULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+		allocPtr = runPtr->xferPtr;
+		runPtr->xferPtr = NULL;
+	}
+	K_CR_EXIT
+	return (allocPtr);
+}
+#endif
+
+#if (K_DEF_ALLOC_CHECK==ON)
+/* Attaches an allocation bitmap of K_MEM_MAP_WORDS(numBlocks) words.
+ * Must be called before the first allocation, as the map starts clear.
+ */
+K_ERR kMemCheckInit( K_MEM *const kobj, ULONG *const mapPtr)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( mapPtr))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_MEM_INIT);
+	}
+	if ((kobj->init == FALSE) || (kobj->nFreeBlocks != kobj->nMaxBlocks))
+	{
+		return (K_ERR_MEM_INIT);
+	}
+	for (ULONG i = 0; i < K_MEM_MAP_WORDS( kobj->nMaxBlocks); ++i)
+	{
+		mapPtr[i] = 0;
+	}
+	kobj->allocMapPtr = mapPtr;
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_ALLOC_STATS==ON)
+K_ERR kMemGetStats( K_MEM *const kobj, K_MEM_STATS *const statsPtr)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( statsPtr))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERROR);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	statsPtr->nMaxBlocks = kobj->nMaxBlocks;
+	statsPtr->nFreeBlocks = kobj->nFreeBlocks;
+	statsPtr->minFreeBlocks = kobj->minFreeBlocks;
+	statsPtr->nAllocs = kobj->nAllocs;
+	statsPtr->nAllocFails = kobj->nAllocFails;
+	/* rate over the window since the previous sample */
+	TICK64 now = kTimeNow64();
+	TICK64 elapsedUs = (now - kobj->rateTick) * K_DEF_TICK_PERIOD_US;
+	ULONG nAllocs = kobj->nAllocs - kobj->rateAllocs;
+	statsPtr->allocsPerSec = 0;
+	if (elapsedUs > 0)
+	{
+		statsPtr->allocsPerSec = ( ULONG) ((( TICK64) nAllocs * 1000000ULL)
+				/ elapsedUs);
+		kobj->rateAllocs = kobj->nAllocs;
+		kobj->rateTick = now;
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+/* The callback runs in the context of the allocating task or ISR */
+K_ERR kMemSetLowMark( K_MEM *const kobj, ULONG const lowMark, CBK const cbk,
+		ADDR const argsPtr)
+{
+	if (IS_NULL_PTR( kobj))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERROR);
+	}
+	if (lowMark >= kobj->nMaxBlocks)
+	{
+		return (K_ERROR);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->lowMarkCbk = NULL;
+	kobj->lowMark = lowMark;
+	kobj->lowMarkArgsPtr = argsPtr;
+	kobj->lowMarkCbk = cbk;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_ALLOC_CLASSES==ON)
+/*******************************************************************************
+ * SIZE-CLASS ALLOCATOR
+ *******************************************************************************/
+/*
+ * A set of block pools ordered by block size. A request of n bytes is mapped
+ * to its octave ceil(log2(n)) with a CLZ, and a per-octave table gives the
+ * first pool whose blocks are at least 2^(octave - 1). From there the pools
+ * are sorted, so the first one that fits is the smallest fitting class, and
+ * the scan only crosses pools of the same octave (e.g., 640, 768 and 896
+ * bytes for n = 700). If that class is exhausted, the next larger classes
+ * are tried.
+ */
+
+/* ceil(log2(n)), n > 0; requests above 2^31 share the last octave */
+static inline ULONG kMemSizeOctave_( ULONG const size)
+{
+	if (size <= 1)
+		return (0);
+	ULONG oct = (8 * sizeof(ULONG)) - __builtin_clzl( size - 1);
+	return ((oct < K_MEM_CLASS_N_OCTAVES) ? oct : K_MEM_CLASS_N_OCTAVES);
+}
+
+K_ERR kMemClassInit( K_MEMCLASS *const kobj, K_MEM *const poolsPtr,
+		ULONG const nPools)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( poolsPtr))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_MEM_INIT);
+	}
+	if ((nPools == 0) || (nPools > K_MEM_CLASS_MAX_POOLS))
+	{
+		return (K_ERR_MEM_INIT);
+	}
+	for (ULONG i = 0; i < nPools; ++i)
+	{
+		if (poolsPtr[i].init == FALSE)
+		{
+			return (K_ERR_MEM_INIT);
+		}
+		/* must be ascending */
+		if ((i > 0) && (poolsPtr[i].blkSize <= poolsPtr[i - 1].blkSize))
+		{
+			return (K_ERR_MEM_INIT);
+		}
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->poolsPtr = poolsPtr;
+	kobj->nPools = nPools;
+	ULONG idx = 0;
+	for (ULONG oct = 0; oct < K_MEM_CLASS_N_OCTAVES; ++oct)
+	{
+		while ((idx < nPools) && (poolsPtr[idx].blkSize < (1UL << oct)))
+		{
+			idx++;
+		}
+		kobj->classTbl[oct] = ( BYTE) idx;
+	}
+	kobj->init = TRUE;
 	K_CR_EXIT
 	return (K_SUCCESS);
 }
 
+ADDR kMemAllocSize( K_MEMCLASS *const kobj, ULONG const size)
+{
+	if (IS_NULL_PTR( kobj) || (kobj->init == FALSE))
+	{
+		return (NULL);
+	}
+	if ((size == 0) || (size > kobj->poolsPtr[kobj->nPools - 1].blkSize))
+	{
+		return (NULL);
+	}
+	ULONG oct = kMemSizeOctave_( size);
+	ULONG idx = (oct > 0) ? kobj->classTbl[oct - 1] : 0;
+	/* ends at the last pool at most: it fits, as checked above */
+	while (kobj->poolsPtr[idx].blkSize < size)
+	{
+		idx++;
+	}
+	for (; idx < kobj->nPools; ++idx)
+	{
+		ADDR allocPtr = kMemAlloc( &kobj->poolsPtr[idx]);
+		if (allocPtr != NULL)
+		{
+			return (allocPtr);
+		}
+	}
+	return (NULL);
+}
+
+K_ERR kMemFreeSize( K_MEMCLASS *const kobj, ADDR const blockPtr)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( blockPtr) || (kobj->init == FALSE))
+	{
+		return (K_ERR_MEM_FREE);
+	}
+	/* owner is found by address range */
+	for (ULONG i = 0; i < kobj->nPools; ++i)
+	{
+		K_MEM *poolPtr = &kobj->poolsPtr[i];
+		BYTE *endPtr = poolPtr->poolPtr
+				+ (poolPtr->blkSize * poolPtr->nMaxBlocks);
+		if (((BYTE*) blockPtr >= poolPtr->poolPtr)
+				&& ((BYTE*) blockPtr < endPtr))
+		{
+			return (kMemFree( poolPtr, blockPtr));
+		}
+	}
+	return (K_ERR_MEM_FREE);
+}
+#endif /* K_DEF_ALLOC_CLASSES */
+
+#if (K_DEF_ALLOC_ARENA==ON)
+/*******************************************************************************
+ * ARENA ALLOCATOR
+ *******************************************************************************/
+/*
+ * Allocations move an offset forward; nothing is freed individually. A mark
+ * is the offset itself, so restoring a mark or resetting the arena drops
+ * every allocation made after it in O(1).
+ */
+
+K_ERR kArenaInit( K_ARENA *const kobj, ADDR const bufPtr, ULONG const size)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( bufPtr))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_MEM_INIT);
+	}
+	if (size == 0)
+	{
+		return (K_ERR_MEM_INIT);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->basePtr = bufPtr;
+	kobj->size = size;
+	kobj->offset = 0;
+	kobj->memPtr = NULL;
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kArenaInitMem( K_ARENA *const kobj, K_MEM *const memPtr)
+{
+	if (IS_NULL_PTR( kobj) || IS_NULL_PTR( memPtr))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_MEM_INIT);
+	}
+	ADDR blockPtr = kMemAlloc( memPtr);
+	if (blockPtr == NULL)
+	{
+		return (K_ERR_MEM_ALLOC);
+	}
+	K_ERR err = kArenaInit( kobj, blockPtr, memPtr->blkSize);
+	kobj->memPtr = memPtr;
+	return (err);
+}
+
+K_ERR kArenaRelease( K_ARENA *const kobj)
+{
+	if (IS_NULL_PTR( kobj))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_MEM_FREE);
+	}
+	if (kobj->init == FALSE)
+	{
+		return (K_ERR_MEM_FREE);
+	}
+	kobj->init = FALSE;
+	if (kobj->memPtr != NULL)
+	{
+		return (kMemFree( kobj->memPtr, kobj->basePtr));
+	}
+	return (K_SUCCESS);
+}
+
+ADDR kArenaAlloc( K_ARENA *const kobj, ULONG const size, ULONG align)
+{
+	if (IS_NULL_PTR( kobj) || (kobj->init == FALSE) || (size == 0))
+	{
+		return (NULL);
+	}
+	if (align == 0)
+	{
+		align = sizeof(ULONG);
+	}
+	/* power of two only */
+	if ((align & (align - 1)) != 0)
+	{
+		return (NULL);
+	}
+	ADDR allocPtr = NULL;
+	K_CR_AREA
+	K_CR_ENTER
+	ULONG addr = ( ULONG) (kobj->basePtr + kobj->offset);
+	ULONG start = ((addr + align - 1) & ~(align - 1)) - ( ULONG) kobj->basePtr;
+	if ((start <= kobj->size) && (size <= (kobj->size - start)))
+	{
+		allocPtr = kobj->basePtr + start;
+		kobj->offset = start + size;
+	}
+	K_CR_EXIT
+	return (allocPtr);
+}
+
+ULONG kArenaMark( K_ARENA *const kobj)
+{
+	if (IS_NULL_PTR( kobj))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (0);
+	}
+	return (kobj->offset);
+}
+
+K_ERR kArenaRestore( K_ARENA *const kobj, ULONG const mark)
+{
+	if (IS_NULL_PTR( kobj))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERROR);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	/* a mark taken after this point has already been dropped */
+	if (mark > kobj->offset)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kobj->offset = mark;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kArenaReset( K_ARENA *const kobj)
+{
+	return (kArenaRestore( kobj, 0));
+}
+
+ULONG kArenaFreeBytes( K_ARENA *const kobj)
+{
+	if (IS_NULL_PTR( kobj))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (0);
+	}
+	return (kobj->size - kobj->offset);
+}
+#endif /* K_DEF_ALLOC_ARENA */
+
 #endif
@@ -21,15 +21,44 @@
  *
  *		  . Queues hold N 4-byte ADDR messages.
  *
+ *		  . Priority Queues hold ADDR messages in one ring per priority
+ *		  level; the highest-priority message is received first.
+ *
+ *		  . Channels carry a request from a client to a server task
+ *		  and its reply back, synchronously, with priority
+ *		  inheritance.
+ *
  *		  . Streams hold N fixed-size messages and work with deep copy.
  *		  All above need static memory allocation, but Queues and Mailbox
  *		  might benefit from dynamic allocation if keeping the scope is
  *		  a problem.
  *
+ *		  . Pipes hold variable-size records, length-prefixed, in a
+ *		  byte ring; records can be received whole or in parts.
+ *
+ *		  . SPSC Rings hold N fixed-size records (or bytes) for one
+ *		  producer and one consumer with no lock; the producer can be
+ *		  an ISR.
+ *
+ *		  . MPSC Queues hold N ADDR messages for many producers, nested
+ *		  ISRs included, and one consumer, with no lock.
+ *
+ *		  . Broadcast Rings hold N fixed-size messages from one producer
+ *		  that every subscribed consumer reads in place, at its own pace.
+ *
  *		  . Pump-Drop Buffers are fully asynchronous mailboxes that
  *		  take care of message integrity with the methods reserve(),
- *		  pump() and drop(). They work with a memory allocator under
- *		  the hood.
+ *		  pump() and drop(). Readers get the newest message in place;
+ *		  a small pool of buffers is shared with atomic operations, so
+ *		  nobody blocks and ISRs can use them.
+ *
+ *		  . Reference-counted messages are blocks of a Memory Pool that
+ *		  return to the pool on the last kMsgUnref(), so a message can
+ *		  be posted to several Queues/Mailboxes with no copy.
+ *
+ *		  . Topics (publish-subscribe) deliver a reference-counted
+ *		  message to the Queue of every subscriber whose filter takes
+ *		  it.
  *
  *		  . Port: When a Mailbox, Queue or Stream is set as a 'Port' of
  *		  a task, only that task can receive from that object, others
@@ -43,6 +72,71 @@
 
 #include "kexecutive.h"
 
+/*
+ * Ring index arithmetic (k <= size): power-of-two rings have a mask and
+ * wrap with an AND, others wrap with a compare. No division either way.
+ */
+#define RING_ADD(idx, k, size, mask) \
+	(((mask) != 0) ? (((idx) + (k)) & (mask)) : \
+	((((idx) + (k)) >= (size)) ? (((idx) + (k)) - (size)) : ((idx) + (k))))
+/* mask of a power-of-two ring, or 0 */
+#define RING_MASK(size) ((((size) & ((size) - 1)) == 0) ? ((size) - 1) : 0)
+
+#if ((K_DEF_QUEUE==ON) || (K_DEF_STREAM==ON) || (K_DEF_PIPE==ON) \
+		|| (K_DEF_PQUEUE==ON) || (K_DEF_BCAST==ON))
+/*
+ * Readies the waiters blocked as 'status' (SENDING or RECEIVING) whose
+ * waitNeed fits in 'avail' (free room for senders, messages for
+ * receivers), in queue order, each one taking its share. Readers and
+ * writers of a queue or stream can be waiting at once (batches, zero-copy
+ * slots), so a woken task still rechecks its condition, and blocks again
+ * with what is left of its time-out if another task was faster.
+ */
+static VOID kMesgWake_( K_TCBQ *const waitingQueuePtr,
+		K_TASK_STATUS const status, ULONG avail)
+{
+	K_NODE *nodePtr = waitingQueuePtr->listDummy.nextPtr;
+	while ((nodePtr != &waitingQueuePtr->listDummy) && (avail > 0))
+	{
+		K_TCB *freeTaskPtr = K_LIST_GET_TCB_NODE( nodePtr, K_TCB);
+		nodePtr = nodePtr->nextPtr;
+		if ((freeTaskPtr->status == status)
+				&& (freeTaskPtr->waitNeed <= avail))
+		{
+			avail -= freeTaskPtr->waitNeed;
+			kTCBQRem( waitingQueuePtr, &freeTaskPtr);
+			kTCBQEnq( &readyQueue[freeTaskPtr->priority], freeTaskPtr);
+			freeTaskPtr->status = READY;
+			if (freeTaskPtr->priority < runPtr->priority)
+			{
+				K_PEND_CTXTSWTCH
+			}
+		}
+	}
+}
+#endif
+
+#if ((K_DEF_SPSC==ON) || (K_DEF_MPSC==ON))
+/*
+ * Lock-free rings park their single consumer in readerPtr, set within a
+ * critical region after the ring was found empty. Producers call this
+ * after publishing, when they see it set. readerPtr is re-read within the
+ * region as another producer or a time-out may have readied it already.
+ */
+static VOID kMesgWakeReader_( K_TCB *volatile *const readerPPtr)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	K_TCB *readerPtr = *readerPPtr;
+	if (readerPtr != NULL)
+	{
+		*readerPPtr = NULL;
+		kReadyCtxtSwtch( readerPtr);
+	}
+	K_CR_EXIT
+}
+#endif
+
 /*******************************************************************************
  * MAILBOXES (EXCHANGE)
  ******************************************************************************/
@@ -67,6 +161,7 @@ K_ERR kMboxInit( K_MBOX *const kobj, ADDR initMailPtr)
 	listerr = kListInit( &kobj->waitingQueue, "mailq");
 	kassert( listerr == 0);
 	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
 	kobj->timeoutNode.timeout = 0;
  	kobj->timeoutNode.objectType = MAILBOX;
 #if(K_DEF_MBOX_POSTPEND_PRIO_INH==ON)
@@ -415,10 +510,280 @@ K_ERR kMboxPostPend( K_MBOX *const kobj, ADDR const sendPtr,
 
 #endif /* mailbox */
 
+/*******************************************************************************
+ * CHANNELS (SEND-RECEIVE-REPLY)
+ *
+ * A client sends a request and blocks until the server replies. The server
+ * receives clients by priority, and replies to each one by its handle, in
+ * any order. Requests and replies are handed over by pointer through the
+ * client's xferPtr.
+ *
+ * The server runs at the highest priority among its own, the clients it is
+ * serving and the clients waiting for it, so a client is never delayed by
+ * tasks of lower priority than its own. When the server is waiting, a send
+ * puts it at the head of its ready queue, so it runs in place of the client.
+ *
+ * The send time-out covers the wait to be received, on the client's own
+ * time-out node; once received, a client waits for the reply.
+ *******************************************************************************/
+#if (K_DEF_CHANNEL==ON)
+
+/* server priority: its own (or what it inherited through a mutex), or
+ * the highest of its clients */
+static VOID kChannelInherit_( K_CHANNEL *const kobj)
+{
+	K_TCB *serverPtr = kobj->serverPtr;
+	if (serverPtr == NULL)
+	{
+		return;
+	}
+#if (K_DEF_MUTEX_PRIO_INH==ON)
+	PRIO prio = serverPtr->mutexPrio;
+#else
+	PRIO prio = serverPtr->realPrio;
+#endif
+	if (kobj->clientQueue.size > 0)
+	{
+		K_TCB *clientPtr = kTCBQPeek( &kobj->clientQueue);
+		if (clientPtr->priority < prio)
+		{
+			prio = clientPtr->priority;
+		}
+	}
+	if (kobj->replyQueue.size > 0)
+	{
+		K_TCB *clientPtr = kTCBQPeek( &kobj->replyQueue);
+		if (clientPtr->priority < prio)
+		{
+			prio = clientPtr->priority;
+		}
+	}
+	kTCBSetPrio( serverPtr, prio);
+}
+
+K_ERR kChannelInit( K_CHANNEL *const kobj)
+{
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->serverPtr = NULL;
+	kobj->serverWaiting = FALSE;
+	K_ERR err = kTCBQInit( &kobj->clientQueue, "chanq");
+	if (err == K_SUCCESS)
+	{
+		err = kTCBQInit( &kobj->replyQueue, "replyq");
+	}
+	if (err != K_SUCCESS)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kChannelSend( K_CHANNEL *const kobj, ADDR const sendPtr,
+		ADDR *const replyPPtr, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if (kIsISR())
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		K_CR_EXIT
+		return (K_ERR_INVALID_ISR_PRIMITIVE);
+	}
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	/* the server would wait for itself */
+	if (kobj->serverPtr == runPtr)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if ((timeout == K_NO_WAIT) && !kobj->serverWaiting)
+	{
+		K_CR_EXIT
+		return (K_ERR_EMPTY_WAITING_QUEUE);
+	}
+	runPtr->xferPtr = sendPtr;
+	runPtr->chanPtr = kobj;
+	kTCBQEnqByPrio( &kobj->clientQueue, runPtr);
+	runPtr->status = SENDING;
+	if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+		kTimeOut( &runPtr->timeoutNode, timeout);
+	kChannelInherit_( kobj);
+	if (kobj->serverWaiting)
+	{
+		/* hand the processor over to the server */
+		K_TCB *serverPtr = kobj->serverPtr;
+		kobj->serverWaiting = FALSE;
+		kTCBQJam( &readyQueue[serverPtr->priority], serverPtr);
+		serverPtr->status = READY;
+	}
+	K_PEND_CTXTSWTCH
+	K_CR_EXIT
+	K_CR_ENTER
+	if (runPtr->timeOut)
+	{
+		/* never received: the time-out took it off clientQueue */
+		runPtr->timeOut = FALSE;
+		kChannelInherit_( kobj);
+		K_CR_EXIT
+		return (K_ERR_TIMEOUT);
+	}
+	if (replyPPtr != NULL)
+	{
+		*replyPPtr = runPtr->xferPtr;
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kChannelReceive( K_CHANNEL *const kobj, ADDR *const recvPPtr,
+		K_TASK_HANDLE *const clientPtr, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if (kIsISR())
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		K_CR_EXIT
+		return (K_ERR_INVALID_ISR_PRIMITIVE);
+	}
+	if ((kobj == NULL) || (recvPPtr == NULL) || (clientPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	/* the first receiver becomes the server */
+	if (kobj->serverPtr == NULL)
+	{
+		kobj->serverPtr = runPtr;
+	}
+	if (kobj->serverPtr != runPtr)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	while (kobj->clientQueue.size == 0)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_EMPTY_WAITING_QUEUE);
+		}
+		/* server and clients each wait on their own time-out node */
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+			kTimeOut( &runPtr->timeoutNode, timeout);
+		kobj->serverWaiting = TRUE;
+		runPtr->status = PENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		kobj->serverWaiting = FALSE;
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+			kRemoveTimeoutNode( &runPtr->timeoutNode);
+	}
+	K_TCB *senderPtr;
+	kTCBQDeq( &kobj->clientQueue, &senderPtr);
+	/* its send time-out is over; it may never have been armed */
+	if (K_TIMEOUT_ARMED( &senderPtr->timeoutNode))
+	{
+		kRemoveTimeoutNode( &senderPtr->timeoutNode);
+	}
+	senderPtr->status = BLOCKED;
+	kTCBQEnqByPrio( &kobj->replyQueue, senderPtr);
+	kChannelInherit_( kobj);
+	*recvPPtr = senderPtr->xferPtr;
+	*clientPtr = senderPtr;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kChannelReply( K_CHANNEL *const kobj, K_TASK_HANDLE const clientPtr,
+		ADDR const replyPtr)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (clientPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	/* only the server replies, to a client it received */
+	if ((kobj->serverPtr != runPtr) || (clientPtr->chanPtr != kobj)
+			|| (clientPtr->status != BLOCKED))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	K_TCB *remPtr = clientPtr;
+	kTCBQRem( &kobj->replyQueue, &remPtr);
+	clientPtr->chanPtr = NULL;
+	clientPtr->xferPtr = replyPtr;
+	/* drop what was inherited from this client before it runs */
+	kChannelInherit_( kobj);
+	kReadyCtxtSwtch( clientPtr);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+#endif /* K_DEF_CHANNEL */
+
 /*******************************************************************************
  * MAIL QUEUE
  ******************************************************************************/
 #if (K_DEF_QUEUE==(ON))
+
+/*
+ * Watermarks: receivers are woken once QUEUE_RECV_MARK mails are in, and
+ * senders once the mails are down to QUEUE_SEND_MARK. Marks left at 0
+ * (objects defined at compile-time) wake on every mail.
+ */
+#if (K_DEF_FUNC_QUEUE_MARKS==ON)
+#define QUEUE_RECV_MARK(k) ((k)->recvMark)
+#define QUEUE_SEND_MARK(k) ((k)->maxItems - (k)->sendRoom)
+#else
+#define QUEUE_RECV_MARK(k) (1UL)
+#define QUEUE_SEND_MARK(k) ((k)->maxItems - 1UL)
+#endif
+
 K_ERR kQueueInit( K_QUEUE *const kobj, ADDR memPtr, ULONG maxItems)
 {
 	K_CR_AREA
@@ -432,13 +797,22 @@ K_ERR kQueueInit( K_QUEUE *const kobj, ADDR memPtr, ULONG maxItems)
 	kobj->headIdx = 0;
 	kobj->tailIdx = 0;
 	kobj->maxItems = maxItems;
+	kobj->idxMask = RING_MASK( maxItems);
 	kobj->countItems = 0;
+#if (K_DEF_FUNC_QUEUE_MARKS==ON)
+	kobj->recvMark = 1;
+	kobj->sendRoom = 1;
+#endif
 	kobj->init = TRUE;
 	K_ERR listerr = kListInit( &kobj->waitingQueue, "qq");
 	kassert( listerr == 0);
 	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
 	kobj->timeoutNode.timeout = 0;
  	kobj->timeoutNode.objectType = QUEUE;
+#if (K_DEF_WAITSET==ON)
+	kobj->waitSetPtr = NULL;
+#endif
 	K_CR_EXIT
 	return (K_SUCCESS);
 }
@@ -462,16 +836,20 @@ K_ERR kQueuePost( K_QUEUE *const kobj, ADDR sendPtr, TICK timeout)
 		KFAULT( FAULT_OBJ_NOT_INIT);
 		return (K_ERROR);
 	}
-	if (kobj->countItems == kobj->maxItems)
+	TICK64 deadline = 0;
+	while (kobj->countItems == kobj->maxItems)
 	{
 		if (timeout == 0)
 		{
 			K_CR_EXIT
 			return (K_ERR_MBOX_FULL);
 		}
-		if ((timeout > 0) && (timeout < K_WAIT_FOREVER))
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
 		{
-			kTimeOut( &kobj->timeoutNode, timeout);
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
 		}
 
 #if(K_DEF_QUEUE_ENQ==K_DEF_ENQ_FIFO)
@@ -479,6 +857,7 @@ K_ERR kQueuePost( K_QUEUE *const kobj, ADDR sendPtr, TICK timeout)
 #else
 		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
 #endif
+		runPtr->waitNeed = 1;
 		runPtr->status = SENDING;
 		K_PEND_CTXTSWTCH
 		K_CR_EXIT
@@ -486,10 +865,15 @@ K_ERR kQueuePost( K_QUEUE *const kobj, ADDR sendPtr, TICK timeout)
 		if (runPtr->timeOut)
 		{
 			runPtr->timeOut = FALSE;
-			K_CR_EXIT
-			return (K_ERR_TIMEOUT);
+			if (kobj->countItems == kobj->maxItems)
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: post if there is room */
+			break;
 		}
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
 			kRemoveTimeoutNode( &kobj->timeoutNode);
 	}
 	/* post on tail */
@@ -497,22 +881,13 @@ K_ERR kQueuePost( K_QUEUE *const kobj, ADDR sendPtr, TICK timeout)
 	ADDR *tailAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->tailIdx);
 	/* sendPtr is enqueued at tailAddr */
 	*tailAddr = sendPtr;
-	kobj->tailIdx = (kobj->tailIdx + 1) % kobj->maxItems;
+	kobj->tailIdx = RING_ADD( kobj->tailIdx, 1, kobj->maxItems, kobj->idxMask);
 	kobj->countItems++;
-	/* unblock a receiver if any */
-	if (kobj->waitingQueue.size > 0)
+	if (kobj->countItems >= QUEUE_RECV_MARK( kobj))
 	{
-		K_TCB *freeReadPtr = kTCBQPeek( &kobj->waitingQueue);
-		if (freeReadPtr->status == RECEIVING)
-		{
-			kTCBQDeq( &kobj->waitingQueue, &freeReadPtr);
-			kTCBQEnq( &readyQueue[freeReadPtr->priority], freeReadPtr);
-			freeReadPtr->status = READY;
-			if (freeReadPtr->priority < runPtr->priority)
-			{
-				K_PEND_CTXTSWTCH
-			}
-		}
+		/* unblock a receiver if any */
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, kobj->countItems);
+		K_WAITSET_NOTIFY( kobj);
 	}
 	K_CR_EXIT
 	return (K_SUCCESS);
@@ -538,22 +913,27 @@ K_ERR kQueuePend( K_QUEUE *const kobj, ADDR *recvPPtr, TICK timeout)
 		K_CR_EXIT
 		return (K_ERROR);
 	}
-	if (kobj->countItems == 0)
+	TICK64 deadline = 0;
+	while (kobj->countItems == 0)
 	{
 		if (timeout == 0)
 		{
 			K_CR_EXIT
 			return (K_ERR_MBOX_EMPTY);
 		}
-		if ((timeout > 0) && (timeout < K_WAIT_FOREVER))
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
 		{
-			kTimeOut( &kobj->timeoutNode, timeout);
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
 		}
 #if(K_DEF_QUEUE_ENQ==K_DEF_ENQ_FIFO)
 			kTCBQEnq(&kobj->waitingQueue, runPtr);
 #else
 		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
 #endif
+		runPtr->waitNeed = 1;
 		runPtr->status = RECEIVING;
 		K_PEND_CTXTSWTCH
 		K_CR_EXIT
@@ -561,42 +941,45 @@ K_ERR kQueuePend( K_QUEUE *const kobj, ADDR *recvPPtr, TICK timeout)
 		if (runPtr->timeOut)
 		{
 			runPtr->timeOut = FALSE;
-			K_CR_EXIT
-			return (K_ERR_TIMEOUT);
+			if (kobj->countItems == 0)
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: take what is in */
+			break;
 		}
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
 			kRemoveTimeoutNode( &kobj->timeoutNode);
 	}
 	/* cast to ULONG* guarantees a 4-byte step-size */
 	ADDR *headAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->headIdx);
 	/* value stored on headAddr is dequeued */
 	*recvPPtr = *headAddr;
-	kobj->headIdx = (kobj->headIdx + 1) % kobj->maxItems;
+	kobj->headIdx = RING_ADD( kobj->headIdx, 1, kobj->maxItems, kobj->idxMask);
 	kobj->countItems--;
-	if (kobj->waitingQueue.size > 0)
+	if (kobj->countItems <= QUEUE_SEND_MARK( kobj))
 	{
-		K_TCB *freeSendPtr = kTCBQPeek( &kobj->waitingQueue);
-		if (freeSendPtr->status == SENDING)
-		{
-			kTCBQDeq( &kobj->waitingQueue, &freeSendPtr);
-			kTCBQEnq( &readyQueue[freeSendPtr->priority], freeSendPtr);
-			freeSendPtr->status = READY;
-			if (freeSendPtr->priority < runPtr->priority)
-			{
-				K_PEND_CTXTSWTCH
-			}
-		}
+		/* unblock a sender if any */
+		kMesgWake_( &kobj->waitingQueue, SENDING,
+				kobj->maxItems - kobj->countItems);
 	}
 	K_CR_EXIT
 	return (K_SUCCESS);
 }
 
-#if (K_DEF_FUNC_QUEUE_PEEK==ON)
-K_ERR kQueuePeek( K_QUEUE *const kobj, ADDR *peekPPtr)
+#if (K_DEF_FUNC_QUEUE_BATCH==ON)
+/*
+ * Batches move up to n mails within one critical region and take one
+ * wake-up decision. K_BATCH_ALL waits until all fit, K_BATCH_ATLEAST1
+ * until one fits, K_BATCH_PARTIAL never waits.
+ */
+K_ERR kQueuePostN( K_QUEUE *const kobj, ADDR *const sendPPtr, ULONG const n,
+		ULONG *const nPostedPtr, ULONG const option, TICK const timeout)
 {
 	K_CR_AREA
 	K_CR_ENTER
-	if (kobj == NULL || peekPPtr == NULL)
+	if ((kobj == NULL) || (sendPPtr == NULL))
 	{
 		KFAULT( FAULT_OBJ_NULL);
 		K_CR_EXIT
@@ -608,52 +991,39 @@ K_ERR kQueuePeek( K_QUEUE *const kobj, ADDR *peekPPtr)
 		K_CR_EXIT
 		return (K_ERROR);
 	}
-	ADDR *headAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->headIdx);
-	*peekPPtr = *headAddr;
-	K_CR_EXIT
-	return (K_SUCCESS);
-}
-#endif
-
-#if (K_DEF_FUNC_QUEUE_JAM==ON)
-K_ERR kQueueJam( K_QUEUE *const kobj, ADDR sendPtr, TICK timeout)
-{
-	K_CR_AREA
-	K_CR_ENTER
-	if (kobj == NULL || sendPtr == NULL)
+	if ((option != K_BATCH_PARTIAL) && IS_BLOCK_ON_ISR( timeout))
 	{
-		KFAULT( FAULT_OBJ_NULL);
-		K_CR_EXIT
-		return (K_ERROR);
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
 	}
-	if (!kobj->init)
+	/* messages that must fit before moving any */
+	ULONG need = (option == K_BATCH_ALL) ? n : 1;
+	if ((n == 0) || (need > kobj->maxItems))
 	{
-		KFAULT( FAULT_OBJ_NOT_INIT);
 		K_CR_EXIT
-		return (K_ERROR);
+		return (K_ERR_INVALID_PARAM);
 	}
-	if (IS_BLOCK_ON_ISR( timeout))
+	TICK64 deadline = 0;
+	while ((option != K_BATCH_PARTIAL)
+			&& ((kobj->maxItems - kobj->countItems) < need))
 	{
-
-		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
-
-	}
-	if (kobj->countItems == kobj->maxItems)
-	{
-		if (timeout == 0)
+		if (timeout == K_NO_WAIT)
 		{
 			K_CR_EXIT
 			return (K_ERR_MBOX_FULL);
 		}
-		if ((timeout > 0) && (timeout < K_WAIT_FOREVER))
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
 		{
-			kTimeOut( &kobj->timeoutNode, timeout);
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
 		}
-#if(K_DEF_QUEUE_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
+#if (K_DEF_QUEUE_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
 #else
 		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
 #endif
+		runPtr->waitNeed = need;
 		runPtr->status = SENDING;
 		K_PEND_CTXTSWTCH
 		K_CR_EXIT
@@ -661,300 +1031,206 @@ K_ERR kQueueJam( K_QUEUE *const kobj, ADDR sendPtr, TICK timeout)
 		if (runPtr->timeOut)
 		{
 			runPtr->timeOut = FALSE;
-			K_CR_EXIT
-			return (K_ERR_TIMEOUT);
-		}
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
-			kRemoveTimeoutNode( &kobj->timeoutNode);
-	}
-	/* empty or wrapped ? just place. otherwise, get back - to match the tail */
-	kobj->headIdx = (kobj->headIdx == 0) ? (0) : (kobj->headIdx - 1);
-	ADDR *putAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->headIdx);
-	*putAddr = sendPtr;
-	kobj->countItems++;
-	/* unblock a receiver if any */
-	if (kobj->waitingQueue.size > 0)
-	{
-		K_TCB *freeReadPtr = kTCBQPeek( &kobj->waitingQueue);
-		if (freeReadPtr->status == RECEIVING)
-		{
-			kTCBQDeq( &kobj->waitingQueue, &freeReadPtr);
-			kTCBQEnq( &readyQueue[freeReadPtr->priority], freeReadPtr);
-			freeReadPtr->status = READY;
-			if (freeReadPtr->priority < runPtr->priority)
+			if ((kobj->maxItems - kobj->countItems) < need)
 			{
-				K_PEND_CTXTSWTCH
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
 			}
+			/* timed out below the watermark: post if there is room */
+			break;
 		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
 	}
-	K_CR_EXIT
-	return (K_SUCCESS);
-}
-#endif
-
-#if (K_DEF_FUNC_QUEUE_MAILCOUNT==ON)
-
-ULONG kQueueMailCount( K_QUEUE *const kobj)
-{
-	return (kobj->countItems);
-}
-#endif
-
-#if (K_DEF_FUNC_QUEUE_ISFULL==ON)
-BOOL kQueueIsFull( K_QUEUE *const kobj)
-{
-	return (kobj->countItems == kobj->maxItems);
-}
-
-#endif
-
-#endif
-
-/*******************************************************************************
- * MESSAGE STREAM
- *******************************************************************************/
-#if(K_DEF_STREAM==ON)
-
-K_ERR kStreamInit( K_STREAM *const kobj, ADDR const buffer,
-		ULONG const mesgSize, ULONG const nMesg)
-
-{
-	K_CR_AREA
-	K_CR_ENTER
-	if ((kobj == NULL) || (buffer == NULL))
+	ULONG nPost = kobj->maxItems - kobj->countItems;
+	if (nPost > n)
 	{
-		K_CR_EXIT
-		return (K_ERR_OBJ_NULL);
+		nPost = n;
 	}
-	if (mesgSize == 0)
+	for (ULONG i = 0; i < nPost; ++i)
 	{
-		K_CR_EXIT
-		return (K_ERR_INVALID_MESG_SIZE);
+		ADDR *tailAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->tailIdx);
+		*tailAddr = sendPPtr[i];
+		kobj->tailIdx = RING_ADD( kobj->tailIdx, 1, kobj->maxItems,
+				kobj->idxMask);
 	}
-	if (nMesg == 0)
+	kobj->countItems += nPost;
+	if ((nPost > 0) && (kobj->countItems >= QUEUE_RECV_MARK( kobj)))
 	{
-		K_CR_EXIT
-		return (K_ERR_INVALID_QUEUE_SIZE);
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, kobj->countItems);
+		K_WAITSET_NOTIFY( kobj);
 	}
-	kobj->buffer = buffer;
-	kobj->mesgSize = mesgSize;
-	kobj->maxMesg = nMesg;
-	kobj->mesgCnt = 0;
-	kobj->readIndex = 0;
-	kobj->writeIndex = 0;
-	K_ERR err = kListInit( &kobj->waitingQueue, "waitingQueue");
-	if (err != 0)
+	K_CR_EXIT
+	if (nPostedPtr != NULL)
 	{
-		K_CR_EXIT
-		return (K_ERROR);
+		*nPostedPtr = nPost;
 	}
-	kobj->timeoutNode.nextPtr = NULL;
-	kobj->timeoutNode.timeout = 0;
- 	kobj->timeoutNode.objectType = STREAM;
-	kobj->init = 1;
-	K_CR_EXIT
-	return (K_SUCCESS);
+	return ((nPost > 0) ? (K_SUCCESS) : (K_ERR_MBOX_FULL));
 }
 
-#if (K_DEF_FUNC_STREAM_PEEK==ON)
-K_ERR kStreamPeek( K_STREAM *const kobj, ADDR recvPtr)
+K_ERR kQueuePendN( K_QUEUE *const kobj, ADDR *const recvPPtr, ULONG const n,
+		ULONG *const nPendedPtr, ULONG const option, TICK const timeout)
 {
 	K_CR_AREA
 	K_CR_ENTER
-	if ((kobj == NULL) || (recvPtr == NULL) || (kobj->init == 0))
+	if ((kobj == NULL) || (recvPPtr == NULL))
 	{
+		KFAULT( FAULT_OBJ_NULL);
 		K_CR_EXIT
 		return (K_ERROR);
 	}
-	if (kobj->mesgCnt == 0)
-	{
-		K_CR_EXIT
-		return (K_ERR_STREAM_EMPTY);
-	}
-	BYTE const *src = (BYTE*)kobj->buffer + (kobj->readIndex * kobj->mesgSize);
-	BYTE *dest = (BYTE*) recvPtr;
-	ULONG err = 0;
-	CPYQ( dest, src, kobj->mesgSize, err);
-	if (err != kobj->mesgSize)
+	if (!kobj->init)
 	{
-		kobj->readIndex = (kobj->readIndex + 1) % kobj->maxMesg;
+		KFAULT( FAULT_OBJ_NOT_INIT);
 		K_CR_EXIT
-		return (K_ERR_MESG_CPY);
+		return (K_ERROR);
 	}
-	K_CR_EXIT
-	return (K_SUCCESS);
-}
-#endif
-
-K_ERR kStreamSend( K_STREAM *const kobj, ADDR const sendPtr, TICK const timeout)
-{
-	K_CR_AREA
-	K_CR_ENTER
-	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == 0))
+	if ((option != K_BATCH_PARTIAL) && IS_BLOCK_ON_ISR( timeout))
 	{
-		K_CR_EXIT
-		return (K_ERROR);
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
 	}
-	if (IS_BLOCK_ON_ISR( timeout))
+	/* messages that must fit before moving any */
+	ULONG need = (option == K_BATCH_ALL) ? n : 1;
+	if ((n == 0) || (need > kobj->maxItems))
 	{
 		K_CR_EXIT
-		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		return (K_ERR_INVALID_PARAM);
 	}
-	if (kobj->mesgCnt >= kobj->maxMesg) /*full*/
+	TICK64 deadline = 0;
+	while ((option != K_BATCH_PARTIAL)
+			&& (kobj->countItems < need))
 	{
 		if (timeout == K_NO_WAIT)
 		{
 			K_CR_EXIT
-			return (K_ERR_STREAM_FULL);
+			return (K_ERR_MBOX_EMPTY);
 		}
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
-			kTimeOut( &kobj->timeoutNode, timeout);
-
-#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_QUEUE_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
 #else
 		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
 #endif
-		runPtr->status = SENDING;
+		runPtr->waitNeed = need;
+		runPtr->status = RECEIVING;
 		K_PEND_CTXTSWTCH
 		K_CR_EXIT
 		K_CR_ENTER
 		if (runPtr->timeOut)
 		{
 			runPtr->timeOut = FALSE;
-			K_CR_EXIT
-			return (K_ERR_TIMEOUT);
+			if (kobj->countItems < need)
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: take what is in */
+			break;
 		}
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
 			kRemoveTimeoutNode( &kobj->timeoutNode);
 	}
-	BYTE *dest = (BYTE*)kobj->buffer + (kobj->writeIndex * kobj->mesgSize);
-	BYTE const *src = (BYTE const*) sendPtr;
-	ULONG err = 0;
-	CPYQ( dest, src, kobj->mesgSize, err);
-	if (err != kobj->mesgSize)
+	ULONG nPend = kobj->countItems;
+	if (nPend > n)
 	{
-		K_CR_EXIT
-		return (K_ERR_MESG_CPY);
+		nPend = n;
 	}
-	kobj->writeIndex = (kobj->writeIndex + 1) % kobj->maxMesg;
-	kobj->mesgCnt++;
-	/* was empty ?*/
-	if ((kobj->waitingQueue.size > 0) && (kobj->mesgCnt == 1))
+	for (ULONG i = 0; i < nPend; ++i)
 	{
-		K_TCB *freeTaskPtr;
-		kTCBQDeq( &kobj->waitingQueue, &freeTaskPtr);
-		kTCBQEnq( &readyQueue[freeTaskPtr->priority], freeTaskPtr);
-		freeTaskPtr->status = READY;
-		if (freeTaskPtr->priority < runPtr->priority)
-		{
-			K_PEND_CTXTSWTCH
-		}
+		ADDR *headAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->headIdx);
+		recvPPtr[i] = *headAddr;
+		kobj->headIdx = RING_ADD( kobj->headIdx, 1, kobj->maxItems,
+				kobj->idxMask);
+	}
+	kobj->countItems -= nPend;
+	if ((nPend > 0) && (kobj->countItems <= QUEUE_SEND_MARK( kobj)))
+	{
+		kMesgWake_( &kobj->waitingQueue, SENDING,
+				kobj->maxItems - kobj->countItems);
 	}
 	K_CR_EXIT
-	return (K_SUCCESS);
+	if (nPendedPtr != NULL)
+	{
+		*nPendedPtr = nPend;
+	}
+	return ((nPend > 0) ? (K_SUCCESS) : (K_ERR_MBOX_EMPTY));
 }
+#endif
 
-K_ERR kStreamRecv( K_STREAM *const kobj, ADDR recvPtr, TICK const timeout)
+#if (K_DEF_FUNC_QUEUE_PEEK==ON)
+K_ERR kQueuePeek( K_QUEUE *const kobj, ADDR *peekPPtr)
 {
 	K_CR_AREA
 	K_CR_ENTER
-	if ((kobj == NULL) || (recvPtr == NULL) || (kobj->init == 0))
+	if (kobj == NULL || peekPPtr == NULL)
 	{
+		KFAULT( FAULT_OBJ_NULL);
 		K_CR_EXIT
 		return (K_ERROR);
 	}
-	if (IS_BLOCK_ON_ISR( timeout))
-	{
-		K_CR_EXIT
-		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
-	}
-	if (kobj->mesgCnt == 0)
-	{
-		if (timeout == K_NO_WAIT)
-		{
-			K_CR_EXIT
-			return (K_ERR_STREAM_EMPTY);
-		}
-
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
-			kTimeOut( &kobj->timeoutNode, timeout);
-#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
-			kTCBQEnq(&kobj->waitingQueue, runPtr);
-#else
-		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
-#endif
-		runPtr->status = RECEIVING;
-		K_PEND_CTXTSWTCH
-		K_CR_EXIT
-		K_CR_ENTER
-		if (runPtr->timeOut)
-		{
-			runPtr->timeOut = FALSE;
-			K_CR_EXIT
-			return (K_ERR_TIMEOUT);
-		}
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
-			kRemoveTimeoutNode( &kobj->timeoutNode);
-	}
-	BYTE const *src = (BYTE*)kobj->buffer + (kobj->readIndex * kobj->mesgSize);
-	BYTE *dest = (BYTE*) recvPtr;
-	ULONG err = 0;
-	CPYQ( dest, src, kobj->mesgSize, err);
-	if (err != kobj->mesgSize)
+	if (!kobj->init)
 	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
 		K_CR_EXIT
-		return (K_ERR_MESG_CPY);
-	}
-	kobj->readIndex = (kobj->readIndex + 1) % kobj->maxMesg;
-	kobj->mesgCnt--;
-
-	/* was full ? unblock */
-	if ((kobj->waitingQueue.size > 0) && (kobj->mesgCnt == (kobj->maxMesg - 1)))
-	{
-		K_TCB *freeTaskPtr;
-		kTCBQDeq( &kobj->waitingQueue, &freeTaskPtr);
-		kTCBQEnq( &readyQueue[freeTaskPtr->priority], freeTaskPtr);
-		freeTaskPtr->status = READY;
-
-		if (freeTaskPtr->priority < runPtr->priority)
-		{
-			K_PEND_CTXTSWTCH
-		}
+		return (K_ERROR);
 	}
+	ADDR *headAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->headIdx);
+	*peekPPtr = *headAddr;
 	K_CR_EXIT
 	return (K_SUCCESS);
 }
+#endif
 
-#if (K_DEF_FUNC_STREAM_JAM == ON)
-K_ERR kStreamJam( K_STREAM *const kobj, ADDR const sendPtr, TICK timeout)
+#if (K_DEF_FUNC_QUEUE_JAM==ON)
+K_ERR kQueueJam( K_QUEUE *const kobj, ADDR sendPtr, TICK timeout)
 {
 	K_CR_AREA
 	K_CR_ENTER
-	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == 0))
+	if (kobj == NULL || sendPtr == NULL)
 	{
+		KFAULT( FAULT_OBJ_NULL);
 		K_CR_EXIT
 		return (K_ERROR);
 	}
-	if (IS_BLOCK_ON_ISR( timeout))
+	if (!kobj->init)
 	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
 		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+
 		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+
 	}
-	if (kobj->mesgCnt >= kobj->maxMesg) /*full*/
+	TICK64 deadline = 0;
+	while (kobj->countItems == kobj->maxItems)
 	{
-		if (timeout == K_NO_WAIT)
+		if (timeout == 0)
 		{
 			K_CR_EXIT
-			return (K_ERR_STREAM_FULL);
+			return (K_ERR_MBOX_FULL);
 		}
-		if (timeout > K_NO_WAIT && timeout < K_WAIT_FOREVER)
-			kTimeOut( &kobj->timeoutNode, timeout);
-#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if(K_DEF_QUEUE_ENQ==K_DEF_ENQ_FIFO)
 			kTCBQEnq(&kobj->waitingQueue, runPtr);
 #else
 		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
 #endif
+		runPtr->waitNeed = 1;
 		runPtr->status = SENDING;
 		K_PEND_CTXTSWTCH
 		K_CR_EXIT
@@ -962,61 +1238,2462 @@ K_ERR kStreamJam( K_STREAM *const kobj, ADDR const sendPtr, TICK timeout)
 		if (runPtr->timeOut)
 		{
 			runPtr->timeOut = FALSE;
-			K_CR_EXIT
-			return (K_ERR_TIMEOUT);
+			if (kobj->countItems == kobj->maxItems)
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: post if there is room */
+			break;
 		}
-		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER))
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
 			kRemoveTimeoutNode( &kobj->timeoutNode);
 	}
-	kobj->readIndex =
-			(kobj->readIndex == 0) ?
-					(kobj->maxMesg - 1) : (kobj->readIndex - 1);
-	BYTE *dest = (BYTE*)kobj->buffer + (kobj->readIndex * kobj->mesgSize);
-	BYTE const *src = (BYTE const*) sendPtr;
-	ULONG err = 0;
-	CPYQ( dest, src, kobj->mesgSize, err);
-	if (err != kobj->mesgSize)
+	/* one slot back from the head, wrapping around */
+	kobj->headIdx =
+			(kobj->headIdx == 0) ? (kobj->maxItems - 1) : (kobj->headIdx - 1);
+	ADDR *putAddr = (ADDR*) ((ULONG*) kobj->mailQPtr + kobj->headIdx);
+	*putAddr = sendPtr;
+	kobj->countItems++;
+	if (kobj->countItems >= QUEUE_RECV_MARK( kobj))
+	{
+		/* unblock a receiver if any */
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, kobj->countItems);
+		K_WAITSET_NOTIFY( kobj);
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_FUNC_QUEUE_MAILCOUNT==ON)
+
+ULONG kQueueMailCount( K_QUEUE *const kobj)
+{
+	return (kobj->countItems);
+}
+#endif
+
+#if (K_DEF_FUNC_QUEUE_ISFULL==ON)
+BOOL kQueueIsFull( K_QUEUE *const kobj)
+{
+	return (kobj->countItems == kobj->maxItems);
+}
+
+#endif
+
+#if (K_DEF_FUNC_QUEUE_MARKS==ON)
+K_ERR kQueueSetMarks( K_QUEUE *const kobj, ULONG const recvMark,
+		ULONG const sendMark)
+{
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	/* a full queue must wake receivers, an empty one senders */
+	if ((recvMark == 0) || (recvMark > kobj->maxItems)
+			|| (sendMark >= kobj->maxItems))
+	{
+		return (K_ERR_INVALID_PARAM);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->recvMark = recvMark;
+	kobj->sendRoom = kobj->maxItems - sendMark;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+#endif
+
+/*******************************************************************************
+ * PRIORITY MAIL QUEUE
+ ******************************************************************************/
+#if (K_DEF_PQUEUE==ON)
+
+/* first mail of the ring of a priority level */
+#define PQUEUE_RING(kobj, prio) ((kobj)->mailQPtr + ((prio) * (kobj)->depth))
+
+/* readies the first sender waiting for room on the level 'prio' */
+static VOID kPQueueWakeSender_( K_PQUEUE *const kobj, PRIO const prio)
+{
+	K_NODE *nodePtr = kobj->waitingQueue.listDummy.nextPtr;
+	while (nodePtr != &kobj->waitingQueue.listDummy)
+	{
+		K_TCB *freeTaskPtr = K_LIST_GET_TCB_NODE( nodePtr, K_TCB);
+		nodePtr = nodePtr->nextPtr;
+		if ((freeTaskPtr->status == SENDING) && (freeTaskPtr->waitNeed == prio))
+		{
+			kTCBQRem( &kobj->waitingQueue, &freeTaskPtr);
+			kTCBQEnq( &readyQueue[freeTaskPtr->priority], freeTaskPtr);
+			freeTaskPtr->status = READY;
+			if (freeTaskPtr->priority < runPtr->priority)
+			{
+				K_PEND_CTXTSWTCH
+			}
+			return;
+		}
+	}
+}
+
+K_ERR kPQueueInit( K_PQUEUE *const kobj, ADDR const memPtr,
+		ULONG const nLevels, ULONG const depth)
+{
+	if ((kobj == NULL) || (memPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if ((nLevels == 0) || (nLevels > K_DEF_PQUEUE_LEVELS))
+	{
+		return (K_ERR_INVALID_PARAM);
+	}
+	if (depth == 0)
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->mailQPtr = ( ADDR*) memPtr;
+	kobj->depth = depth;
+	kobj->idxMask = RING_MASK( depth);
+	kobj->nLevels = nLevels;
+	kobj->levelMask = 0;
+	for (ULONG i = 0; i < nLevels; i++)
+	{
+		kobj->headIdx[i] = 0;
+		kobj->countLevel[i] = 0;
+	}
+	kobj->countItems = 0;
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.objectType = PQUEUE;
+	kListInit( &kobj->waitingQueue, "pqq");
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kPQueuePost( K_PQUEUE *const kobj, ADDR const sendPtr, PRIO const prio,
+		TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		K_CR_EXIT
+		return (K_ERR_INVALID_ISR_PRIMITIVE);
+	}
+	if ((kobj == NULL) || (sendPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	if (prio >= kobj->nLevels)
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_PARAM);
+	}
+	/* only the ring of this level has to have room */
+	TICK64 deadline = 0;
+	while (kobj->countLevel[prio] == kobj->depth)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_MBOX_FULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_PQUEUE_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		/* a sender waits for its own level */
+		runPtr->waitNeed = prio;
+		runPtr->status = SENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	ULONG tailIdx = RING_ADD( kobj->headIdx[prio], kobj->countLevel[prio],
+			kobj->depth, kobj->idxMask);
+	PQUEUE_RING( kobj, prio)[tailIdx] = sendPtr;
+	kobj->countLevel[prio]++;
+	kobj->countItems++;
+	kobj->levelMask |= (1UL << prio);
+	/* unblock a receiver if any */
+	kMesgWake_( &kobj->waitingQueue, RECEIVING, kobj->countItems);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kPQueuePend( K_PQUEUE *const kobj, ADDR *const recvPPtr,
+		PRIO *const prioPtr, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		K_CR_EXIT
+		return (K_ERR_INVALID_ISR_PRIMITIVE);
+	}
+	if ((kobj == NULL) || (recvPPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	TICK64 deadline = 0;
+	while (kobj->countItems == 0)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_MBOX_EMPTY);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_PQUEUE_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = RECEIVING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	/* least significant bit set: highest priority level holding mails */
+	PRIO prio = ( PRIO) __builtin_ctz( ( UINT) kobj->levelMask);
+	*recvPPtr = PQUEUE_RING( kobj, prio)[kobj->headIdx[prio]];
+	kobj->headIdx[prio] = RING_ADD( kobj->headIdx[prio], 1, kobj->depth,
+			kobj->idxMask);
+	kobj->countLevel[prio]--;
+	if (kobj->countLevel[prio] == 0)
+	{
+		kobj->levelMask &= ~(1UL << prio);
+	}
+	kobj->countItems--;
+	if (prioPtr != NULL)
+	{
+		*prioPtr = prio;
+	}
+	/* unblock a sender of this level, if any */
+	kPQueueWakeSender_( kobj, prio);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+ULONG kPQueueMailCount( K_PQUEUE *const kobj)
+{
+	return (kobj->countItems);
+}
+
+#endif /* K_DEF_PQUEUE */
+
+/*******************************************************************************
+ * MESSAGE STREAM
+ *******************************************************************************/
+#if(K_DEF_STREAM==ON)
+
+/* word-copy path, chosen at kStreamInit(); else the generic engine */
+static inline ULONG kStreamCpy_( K_STREAM const *const kobj, BYTE *const dest,
+		BYTE const *const src)
+{
+	if ((kobj->mesgWords != 0) && (((( ULONG) dest | ( ULONG) src) & 0x03) == 0))
+	{
+		kCpyWords( (K_WORD*) dest, (K_WORD const*) src, kobj->mesgWords);
+		return (kobj->mesgSize);
+	}
+	return (kCpy( dest, (ADDR) src, kobj->mesgSize));
+}
+
+/*
+ * While a slot is reserved (or acquired), the write (or read) cursor
+ * cannot move, so other writers (or readers) wait as if the stream were
+ * full (or empty).
+ */
+#if (K_DEF_FUNC_STREAM_ZEROCOPY==ON)
+#define STREAM_RESERVED(k) ((k)->reserved)
+#define STREAM_ACQUIRED(k) ((k)->acquired)
+#else
+#define STREAM_RESERVED(k) (FALSE)
+#define STREAM_ACQUIRED(k) (FALSE)
+#endif
+/* a writer at the tail must wait */
+#define STREAM_NO_SLOT(k) \
+	(((k)->mesgCnt >= (k)->maxMesg) || STREAM_RESERVED(k))
+/* a writer at the head (jam) must wait */
+#define STREAM_NO_HEAD(k) \
+	((((k)->mesgCnt + STREAM_RESERVED(k)) >= (k)->maxMesg) || STREAM_ACQUIRED(k))
+/* a reader must wait */
+#define STREAM_NO_MESG(k) \
+	(((k)->mesgCnt == 0) || STREAM_ACQUIRED(k))
+/* room and messages a woken writer or reader can take */
+#define STREAM_ROOM(k) \
+	(STREAM_RESERVED(k) ? 0UL : ((k)->maxMesg - (k)->mesgCnt))
+#define STREAM_MESGS(k) \
+	(STREAM_ACQUIRED(k) ? 0UL : (k)->mesgCnt)
+
+/*
+ * Watermarks: receivers are woken once STREAM_RECV_MARK messages are in,
+ * and senders once the messages are down to STREAM_SEND_MARK. Marks left
+ * at 0 (objects defined at compile-time) wake on every message.
+ */
+#if (K_DEF_FUNC_STREAM_MARKS==ON)
+#define STREAM_RECV_MARK(k) ((k)->recvMark)
+#define STREAM_SEND_MARK(k) ((k)->maxMesg - (k)->sendRoom)
+#else
+#define STREAM_RECV_MARK(k) (1UL)
+#define STREAM_SEND_MARK(k) ((k)->maxMesg - 1UL)
+#endif
+
+/*
+ * Overwrite mode: senders never wait. Room is made by dropping the oldest
+ * messages, unless the head is being read in place; then the messages
+ * that find no room are the ones lost.
+ */
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+#define STREAM_OVW(k) ((k)->overwrite)
+
+/* drops the oldest messages so n (<= maxMesg) fit; returns the room */
+static inline ULONG kStreamDropOldest_( K_STREAM *const kobj, ULONG const n)
+{
+	ULONG room = kobj->maxMesg - kobj->mesgCnt;
+	if ((room < n) && !STREAM_ACQUIRED( kobj))
+	{
+		ULONG nDrop = n - room;
+		kobj->readIndex = RING_ADD( kobj->readIndex, nDrop, kobj->maxMesg,
+				kobj->idxMask);
+		kobj->mesgCnt -= nDrop;
+		kobj->nDropped += nDrop;
+		room = n;
+	}
+	return (room);
+}
+#else
+#define STREAM_OVW(k) (FALSE)
+#endif
+
+K_ERR kStreamInit( K_STREAM *const kobj, ADDR const buffer,
+		ULONG const mesgSize, ULONG const nMesg)
+
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (buffer == NULL))
+	{
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (mesgSize == 0)
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	if (nMesg == 0)
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	kobj->buffer = buffer;
+	kobj->mesgSize = mesgSize;
+	/* whole words in an aligned ring: slots stay aligned, so messages can
+	 * be copied by words when the caller buffer is aligned too */
+	kobj->mesgWords = 0;
+	if (((mesgSize & 0x03) == 0) && ((( ULONG) buffer & 0x03) == 0))
+	{
+		kobj->mesgWords = mesgSize / sizeof(K_WORD);
+	}
+	kobj->maxMesg = nMesg;
+	kobj->idxMask = RING_MASK( nMesg);
+	kobj->mesgCnt = 0;
+	kobj->readIndex = 0;
+	kobj->writeIndex = 0;
+#if (K_DEF_FUNC_STREAM_ZEROCOPY==ON)
+	kobj->reserved = FALSE;
+	kobj->acquired = FALSE;
+#endif
+#if (K_DEF_FUNC_STREAM_MARKS==ON)
+	kobj->recvMark = 1;
+	kobj->sendRoom = 1;
+#endif
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+	kobj->overwrite = FALSE;
+	kobj->nDropped = 0;
+#endif
+	K_ERR err = kListInit( &kobj->waitingQueue, "waitingQueue");
+	if (err != 0)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+ 	kobj->timeoutNode.objectType = STREAM;
+#if (K_DEF_WAITSET==ON)
+	kobj->waitSetPtr = NULL;
+#endif
+	kobj->init = 1;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+K_ERR kStreamInitOvw( K_STREAM *const kobj, ADDR const buffer,
+		ULONG const mesgSize, ULONG const nMesg)
+{
+	K_ERR err = kStreamInit( kobj, buffer, mesgSize, nMesg);
+	if (err == K_SUCCESS)
+	{
+		kobj->overwrite = TRUE;
+	}
+	return (err);
+}
+
+K_ERR kStreamGetDropped( K_STREAM *const kobj, ULONG *const nDroppedPtr)
+{
+	K_CR_AREA
+	if ((kobj == NULL) || (nDroppedPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	K_CR_ENTER
+	*nDroppedPtr = kobj->nDropped;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_FUNC_STREAM_PEEK==ON)
+K_ERR kStreamPeek( K_STREAM *const kobj, ADDR recvPtr)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (recvPtr == NULL) || (kobj->init == 0))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (kobj->mesgCnt == 0)
+	{
+		K_CR_EXIT
+		return (K_ERR_STREAM_EMPTY);
+	}
+	BYTE const *src = (BYTE*)kobj->buffer + (kobj->readIndex * kobj->mesgSize);
+	BYTE *dest = (BYTE*) recvPtr;
+	ULONG err = kStreamCpy_( kobj, dest, src);
+	if (err != kobj->mesgSize)
+	{
+		kobj->readIndex = RING_ADD( kobj->readIndex, 1, kobj->maxMesg,
+				kobj->idxMask);
+		K_CR_EXIT
+		return (K_ERR_MESG_CPY);
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+K_ERR kStreamSend( K_STREAM *const kobj, ADDR const sendPtr, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == 0))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (!STREAM_OVW( kobj) && IS_BLOCK_ON_ISR( timeout))
+	{
+		K_CR_EXIT
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+	if (STREAM_OVW( kobj) && (STREAM_RESERVED( kobj)
+			|| (kStreamDropOldest_( kobj, 1) == 0)))
+	{
+		/* no slot can be freed: this message is the one lost */
+		kobj->nDropped++;
+		K_CR_EXIT
+		return (K_SUCCESS);
+	}
+#endif
+	TICK64 deadline = 0;
+	while (STREAM_NO_SLOT( kobj)) /*full*/
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_FULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+
+#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+			kTCBQEnq(&kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = SENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			if (STREAM_NO_SLOT( kobj))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: post if there is room */
+			break;
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	BYTE *dest = (BYTE*)kobj->buffer + (kobj->writeIndex * kobj->mesgSize);
+	BYTE const *src = (BYTE const*) sendPtr;
+	ULONG err = kStreamCpy_( kobj, dest, src);
+	if (err != kobj->mesgSize)
+	{
+		K_CR_EXIT
+		return (K_ERR_MESG_CPY);
+	}
+	kobj->writeIndex = RING_ADD( kobj->writeIndex, 1, kobj->maxMesg,
+			kobj->idxMask);
+	kobj->mesgCnt++;
+	/* unblock a reader, if any */
+	if (kobj->mesgCnt >= STREAM_RECV_MARK( kobj))
+	{
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, STREAM_MESGS( kobj));
+		K_WAITSET_NOTIFY( kobj);
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kStreamRecv( K_STREAM *const kobj, ADDR recvPtr, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (recvPtr == NULL) || (kobj->init == 0))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		K_CR_EXIT
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	TICK64 deadline = 0;
+	while (STREAM_NO_MESG( kobj))
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_EMPTY);
+		}
+
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+			kTCBQEnq(&kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = RECEIVING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			if (STREAM_NO_MESG( kobj))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: take what is in */
+			break;
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	BYTE const *src = (BYTE*)kobj->buffer + (kobj->readIndex * kobj->mesgSize);
+	BYTE *dest = (BYTE*) recvPtr;
+	ULONG err = kStreamCpy_( kobj, dest, src);
+	if (err != kobj->mesgSize)
+	{
+		K_CR_EXIT
+		return (K_ERR_MESG_CPY);
+	}
+	kobj->readIndex = RING_ADD( kobj->readIndex, 1, kobj->maxMesg,
+			kobj->idxMask);
+	kobj->mesgCnt--;
+	/* unblock a writer, if any */
+	if (kobj->mesgCnt <= STREAM_SEND_MARK( kobj))
+	{
+		kMesgWake_( &kobj->waitingQueue, SENDING, STREAM_ROOM( kobj));
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+#if (K_DEF_FUNC_STREAM_BATCH==ON)
+/* copies nMesg messages between the ring, from slot idx, and a linear
+ * buffer; at most two chunks as the ring wraps */
+static inline VOID kStreamCpyN_( K_STREAM const *const kobj, ULONG const idx,
+		BYTE *const userPtr, ULONG const nMesg, BOOL const toRing)
+{
+	ULONG nFirst = kobj->maxMesg - idx;
+	if (nFirst > nMesg)
+	{
+		nFirst = nMesg;
+	}
+	BYTE *ringPtr = (BYTE*) kobj->buffer + (idx * kobj->mesgSize);
+	ULONG firstSize = nFirst * kobj->mesgSize;
+	ULONG restSize = (nMesg - nFirst) * kobj->mesgSize;
+	if (toRing)
+	{
+		kCpy( ringPtr, userPtr, firstSize);
+		kCpy( kobj->buffer, userPtr + firstSize, restSize);
+	}
+	else
+	{
+		kCpy( userPtr, ringPtr, firstSize);
+		kCpy( userPtr + firstSize, kobj->buffer, restSize);
+	}
+}
+
+/*
+ * Batches move up to n messages, laid out back to back in the caller
+ * buffer, within one critical region and take one wake-up decision.
+ * K_BATCH_ALL waits until all fit, K_BATCH_ATLEAST1 until one fits,
+ * K_BATCH_PARTIAL never waits.
+ */
+K_ERR kStreamSendN( K_STREAM *const kobj, ADDR const sendPtr, ULONG const n,
+		ULONG *const nSentPtr, ULONG const option, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (sendPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if ((option != K_BATCH_PARTIAL) && !STREAM_OVW( kobj)
+			&& IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	/* messages that must fit before moving any */
+	ULONG need = (option == K_BATCH_ALL) ? n : 1;
+	if ((n == 0) || (need > kobj->maxMesg))
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_PARAM);
+	}
+	TICK64 deadline = 0;
+	while ((option != K_BATCH_PARTIAL) && !STREAM_OVW( kobj)
+			&& (((kobj->maxMesg - kobj->mesgCnt) < need) || STREAM_RESERVED( kobj)))
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_FULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = need;
+		runPtr->status = SENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			if (((kobj->maxMesg - kobj->mesgCnt) < need)
+					|| STREAM_RESERVED( kobj))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: post if there is room */
+			break;
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	ULONG nSend = 0;
+	BYTE *srcPtr = ( BYTE*) sendPtr;
+	if (!STREAM_RESERVED( kobj))
+	{
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+		if (STREAM_OVW( kobj))
+		{
+			/* the newest maxMesg messages of the batch are kept */
+			ULONG nSkip = (n > kobj->maxMesg) ? (n - kobj->maxMesg) : 0;
+			srcPtr += nSkip * kobj->mesgSize;
+			kStreamDropOldest_( kobj, n - nSkip);
+		}
+#endif
+		nSend = kobj->maxMesg - kobj->mesgCnt;
+		if (nSend > n)
+		{
+			nSend = n;
+		}
+	}
+	kStreamCpyN_( kobj, kobj->writeIndex, srcPtr, nSend, TRUE);
+	kobj->writeIndex = RING_ADD( kobj->writeIndex, nSend, kobj->maxMesg,
+			kobj->idxMask);
+	kobj->mesgCnt += nSend;
+#if (K_DEF_FUNC_STREAM_OVW==ON)
+	if (STREAM_OVW( kobj))
+	{
+		/* whatever did not fit was dropped: the call still succeeds */
+		kobj->nDropped += n - nSend;
+	}
+#endif
+	if ((nSend > 0) && (kobj->mesgCnt >= STREAM_RECV_MARK( kobj)))
+	{
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, STREAM_MESGS( kobj));
+		K_WAITSET_NOTIFY( kobj);
+	}
+	K_CR_EXIT
+	if (nSentPtr != NULL)
+	{
+		*nSentPtr = nSend;
+	}
+	return (((nSend > 0) || STREAM_OVW( kobj)) ? (K_SUCCESS) :
+			(K_ERR_STREAM_FULL));
+}
+
+K_ERR kStreamRecvN( K_STREAM *const kobj, ADDR const recvPtr, ULONG const n,
+		ULONG *const nRecvPtr, ULONG const option, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (recvPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if ((option != K_BATCH_PARTIAL) && IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	/* messages that must fit before moving any */
+	ULONG need = (option == K_BATCH_ALL) ? n : 1;
+	if ((n == 0) || (need > kobj->maxMesg))
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_PARAM);
+	}
+	TICK64 deadline = 0;
+	while ((option != K_BATCH_PARTIAL)
+			&& ((kobj->mesgCnt < need) || STREAM_ACQUIRED( kobj)))
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_EMPTY);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = need;
+		runPtr->status = RECEIVING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			if ((kobj->mesgCnt < need) || STREAM_ACQUIRED( kobj))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: take what is in */
+			break;
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	ULONG nRecv = 0;
+	if (!STREAM_ACQUIRED( kobj))
+	{
+		nRecv = kobj->mesgCnt;
+		if (nRecv > n)
+		{
+			nRecv = n;
+		}
+	}
+	kStreamCpyN_( kobj, kobj->readIndex, ( BYTE*) recvPtr, nRecv, FALSE);
+	kobj->readIndex = RING_ADD( kobj->readIndex, nRecv, kobj->maxMesg,
+			kobj->idxMask);
+	kobj->mesgCnt -= nRecv;
+	if ((nRecv > 0) && (kobj->mesgCnt <= STREAM_SEND_MARK( kobj)))
+	{
+		kMesgWake_( &kobj->waitingQueue, SENDING, STREAM_ROOM( kobj));
+	}
+	K_CR_EXIT
+	if (nRecvPtr != NULL)
+	{
+		*nRecvPtr = nRecv;
+	}
+	return ((nRecv > 0) ? (K_SUCCESS) : (K_ERR_STREAM_EMPTY));
+}
+#endif
+
+#if (K_DEF_FUNC_STREAM_JAM == ON)
+K_ERR kStreamJam( K_STREAM *const kobj, ADDR const sendPtr, TICK timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (sendPtr == NULL) || (kobj->init == 0))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		K_CR_EXIT
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	TICK64 deadline = 0;
+	while (STREAM_NO_HEAD( kobj)) /*full*/
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_FULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+			kTCBQEnq(&kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = SENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			if (STREAM_NO_HEAD( kobj))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: post if there is room */
+			break;
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	kobj->readIndex =
+			(kobj->readIndex == 0) ?
+					(kobj->maxMesg - 1) : (kobj->readIndex - 1);
+	BYTE *dest = (BYTE*)kobj->buffer + (kobj->readIndex * kobj->mesgSize);
+	BYTE const *src = (BYTE const*) sendPtr;
+	ULONG err = kStreamCpy_( kobj, dest, src);
+	if (err != kobj->mesgSize)
 	{
 		/* restore the read index on failure */
-		kobj->readIndex = (kobj->readIndex + 1) % kobj->maxMesg;
+		kobj->readIndex = RING_ADD( kobj->readIndex, 1, kobj->maxMesg,
+				kobj->idxMask);
+		K_CR_EXIT
+		return (K_ERR_MESG_CPY);
+	}
+	/*succeded */
+	kobj->mesgCnt++;
+	/* unblock a reader, if any */
+	if (kobj->mesgCnt >= STREAM_RECV_MARK( kobj))
+	{
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, STREAM_MESGS( kobj));
+		K_WAITSET_NOTIFY( kobj);
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_FUNC_STREAM_ZEROCOPY==ON)
+/*
+ * Zero-copy access. A producer reserves the slot at the tail, fills it in
+ * place and commits it; a consumer acquires the slot at the head, reads it
+ * in place and releases it. One reservation and one acquisition can be
+ * outstanding per stream.
+ */
+K_ERR kStreamReserve( K_STREAM *const kobj, ADDR *const slotPPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (slotPPtr == NULL) || (kobj->init == 0))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		K_CR_EXIT
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	TICK64 deadline = 0;
+	while (STREAM_NO_SLOT( kobj))
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_FULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = SENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			if (STREAM_NO_SLOT( kobj))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: post if there is room */
+			break;
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	kobj->reserved = TRUE;
+	*slotPPtr = (BYTE*) kobj->buffer + (kobj->writeIndex * kobj->mesgSize);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kStreamCommit( K_STREAM *const kobj)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (kobj->init == 0) || (kobj->reserved == FALSE))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kobj->reserved = FALSE;
+	kobj->writeIndex = RING_ADD( kobj->writeIndex, 1, kobj->maxMesg,
+			kobj->idxMask);
+	kobj->mesgCnt++;
+	if (kobj->mesgCnt >= STREAM_RECV_MARK( kobj))
+	{
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, STREAM_MESGS( kobj));
+		K_WAITSET_NOTIFY( kobj);
+	}
+	/* tail is free again */
+	kMesgWake_( &kobj->waitingQueue, SENDING, STREAM_ROOM( kobj));
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kStreamAcquire( K_STREAM *const kobj, ADDR *const slotPPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (slotPPtr == NULL) || (kobj->init == 0))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		K_CR_EXIT
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	TICK64 deadline = 0;
+	while (STREAM_NO_MESG( kobj))
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_EMPTY);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_STREAM_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = RECEIVING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			if (STREAM_NO_MESG( kobj))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			/* timed out below the watermark: take what is in */
+			break;
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	kobj->acquired = TRUE;
+	*slotPPtr = (BYTE*) kobj->buffer + (kobj->readIndex * kobj->mesgSize);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kStreamRelease( K_STREAM *const kobj)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (kobj->init == 0) || (kobj->acquired == FALSE))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kobj->acquired = FALSE;
+	kobj->readIndex = RING_ADD( kobj->readIndex, 1, kobj->maxMesg,
+			kobj->idxMask);
+	kobj->mesgCnt--;
+	if (kobj->mesgCnt <= STREAM_SEND_MARK( kobj))
+	{
+		kMesgWake_( &kobj->waitingQueue, SENDING, STREAM_ROOM( kobj));
+	}
+	/* head is free again */
+	kMesgWake_( &kobj->waitingQueue, RECEIVING, STREAM_MESGS( kobj));
+	K_WAITSET_NOTIFY( kobj);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_FUNC_STREAM_MARKS==ON)
+K_ERR kStreamSetMarks( K_STREAM *const kobj, ULONG const recvMark,
+		ULONG const sendMark)
+{
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	/* a full stream must wake receivers, an empty one senders */
+	if ((recvMark == 0) || (recvMark > kobj->maxMesg)
+			|| (sendMark >= kobj->maxMesg))
+	{
+		return (K_ERR_INVALID_PARAM);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->recvMark = recvMark;
+	kobj->sendRoom = kobj->maxMesg - sendMark;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+#endif
+
+#if (K_DEF_FUNC_STREAM_MESGCOUNT==ON)
+K_ERR kStreamGetMesgCount( K_STREAM *const kobj, UINT *const mesgCntPtr)
+{
+	K_CR_AREA
+	if (kobj)
+	{
+		K_CR_ENTER
+		*mesgCntPtr = kobj->mesgCnt;
+		K_CR_EXIT
+		return (K_SUCCESS);
+	}
+	return (K_ERR_OBJ_NULL);
+}
+#endif
+
+#endif /*K_DEF_STREAM*/
+
+/*******************************************************************************
+ * PIPES
+ *
+ * A byte ring of variable-size records, each prefixed by its length, so
+ * records take only their own size plus a K_PIPE_HDR_SIZE header. A
+ * record can be received whole, or read in parts: the header is consumed
+ * with the first part and recLeft tracks what is left of the record.
+ *******************************************************************************/
+#if (K_DEF_PIPE==ON)
+
+/* copies n bytes between the ring, from index idx, and a linear buffer;
+ * at most two chunks as the ring wraps */
+static inline VOID kPipeCpy_( K_PIPE const *const kobj, ULONG const idx,
+		BYTE *const userPtr, ULONG const n, BOOL const toRing)
+{
+	ULONG nFirst = kobj->size - idx;
+	if (nFirst > n)
+	{
+		nFirst = n;
+	}
+	if (toRing)
+	{
+		kCpy( kobj->buffer + idx, userPtr, nFirst);
+		kCpy( kobj->buffer, userPtr + nFirst, n - nFirst);
+	}
+	else
+	{
+		kCpy( userPtr, kobj->buffer + idx, nFirst);
+		kCpy( userPtr + nFirst, kobj->buffer, n - nFirst);
+	}
+}
+
+K_ERR kPipeInit( K_PIPE *const kobj, ADDR const buffer, ULONG const size)
+{
+	if ((kobj == NULL) || (buffer == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (size <= K_PIPE_HDR_SIZE)
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->buffer = ( BYTE*) buffer;
+	kobj->size = size;
+	kobj->idxMask = RING_MASK( size);
+	kobj->readIndex = 0;
+	kobj->writeIndex = 0;
+	kobj->byteCnt = 0;
+	kobj->recCnt = 0;
+	kobj->recLeft = 0;
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.objectType = PIPE;
+#if (K_DEF_WAITSET==ON)
+	kobj->waitSetPtr = NULL;
+#endif
+	kListInit( &kobj->waitingQueue, "pipeq");
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kPipeSend( K_PIPE *const kobj, ADDR const sendPtr, ULONG const size,
+		TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (sendPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	ULONG need = K_PIPE_HDR_SIZE + size;
+	if ((size == 0) || (size > K_PIPE_MAX_REC) || (need > kobj->size))
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	TICK64 deadline = 0;
+	while ((kobj->size - kobj->byteCnt) < need)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_FULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_PIPE_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = need;
+		runPtr->status = SENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	BYTE hdr[K_PIPE_HDR_SIZE] =
+	{ ( BYTE) size, ( BYTE) (size >> 8) };
+	kPipeCpy_( kobj, kobj->writeIndex, hdr, K_PIPE_HDR_SIZE, TRUE);
+	ULONG idx = RING_ADD( kobj->writeIndex, K_PIPE_HDR_SIZE, kobj->size,
+			kobj->idxMask);
+	kPipeCpy_( kobj, idx, ( BYTE*) sendPtr, size, TRUE);
+	kobj->writeIndex = RING_ADD( idx, size, kobj->size, kobj->idxMask);
+	kobj->byteCnt += need;
+	kobj->recCnt++;
+	kMesgWake_( &kobj->waitingQueue, RECEIVING, kobj->recCnt);
+	K_WAITSET_NOTIFY( kobj);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+/*
+ * Takes from the front record: all that is left of it (whole) or up to
+ * maxSize bytes of it. A whole receive into a buffer too small leaves the
+ * record in place and reports its size.
+ */
+static K_ERR kPipeRecv_( K_PIPE *const kobj, ADDR const recvPtr,
+		ULONG const maxSize, ULONG *const sizePtr, BOOL const whole,
+		TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (recvPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	if (maxSize == 0)
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_PARAM);
+	}
+	TICK64 deadline = 0;
+	while (kobj->recCnt == 0)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_EMPTY);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_PIPE_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = RECEIVING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	ULONG idx = kobj->readIndex;
+	ULONG left = kobj->recLeft;
+	ULONG hdrSize = 0;
+	if (left == 0)
+	{
+		/* at a header: a new record */
+		BYTE hdr[K_PIPE_HDR_SIZE];
+		kPipeCpy_( kobj, idx, hdr, K_PIPE_HDR_SIZE, FALSE);
+		left = ( ULONG) hdr[0] | (( ULONG) hdr[1] << 8);
+		hdrSize = K_PIPE_HDR_SIZE;
+	}
+	ULONG n = left;
+	if (n > maxSize)
+	{
+		if (whole)
+		{
+			K_CR_EXIT
+			if (sizePtr != NULL)
+			{
+				*sizePtr = left;
+			}
+			return (K_ERR_INVALID_MESG_SIZE);
+		}
+		n = maxSize;
+	}
+	idx = RING_ADD( idx, hdrSize, kobj->size, kobj->idxMask);
+	kPipeCpy_( kobj, idx, ( BYTE*) recvPtr, n, FALSE);
+	kobj->readIndex = RING_ADD( idx, n, kobj->size, kobj->idxMask);
+	kobj->byteCnt -= (hdrSize + n);
+	kobj->recLeft = left - n;
+	if (kobj->recLeft == 0)
+	{
+		kobj->recCnt--;
+	}
+	else
+	{
+		/* the rest of a record read in parts is for the next receiver */
+		kMesgWake_( &kobj->waitingQueue, RECEIVING, 1);
+	}
+	/* a sender waits for room for its record and header */
+	kMesgWake_( &kobj->waitingQueue, SENDING, kobj->size - kobj->byteCnt);
+	K_CR_EXIT
+	if (sizePtr != NULL)
+	{
+		*sizePtr = n;
+	}
+	return (K_SUCCESS);
+}
+
+K_ERR kPipeRecv( K_PIPE *const kobj, ADDR const recvPtr, ULONG const maxSize,
+		ULONG *const sizePtr, TICK const timeout)
+{
+	return (kPipeRecv_( kobj, recvPtr, maxSize, sizePtr, TRUE, timeout));
+}
+
+K_ERR kPipeRead( K_PIPE *const kobj, ADDR const recvPtr, ULONG const nBytes,
+		ULONG *const nReadPtr, TICK const timeout)
+{
+	return (kPipeRecv_( kobj, recvPtr, nBytes, nReadPtr, FALSE, timeout));
+}
+
+#endif /* K_DEF_PIPE */
+
+/*******************************************************************************
+ * SPSC RING
+ *
+ * One producer, one consumer, no lock. head is only written by the producer
+ * and tail only by the consumer; both run freely and wrap with the mask, so
+ * head - tail is the fill level. The producer copies records in, then
+ * publishes head; the consumer copies records out, then publishes tail.
+ *
+ * The producer never blocks nor masks interrupts, and can be an ISR. The
+ * consumer is a task; when the ring is empty it parks itself in readerPtr
+ * within a critical region and blocks. The producer reads readerPtr after
+ * publishing head and wakes the consumer only if it is set, that is, only
+ * on an empty to non-empty transition.
+ *
+ *******************************************************************************/
+#if (K_DEF_SPSC==ON)
+
+/* copies n records between the ring, from free-running index idx, and a
+ * linear buffer; at most two chunks as the ring wraps */
+static inline VOID kSpscCpy_( K_SPSC const *const kobj, ULONG const idx,
+		BYTE *const userPtr, ULONG const n, BOOL const toRing)
+{
+	ULONG pos = idx & kobj->mask;
+	ULONG nFirst = kobj->nRecs - pos;
+	if (nFirst > n)
+	{
+		nFirst = n;
+	}
+	BYTE *ringPtr = kobj->buffer + (pos * kobj->recSize);
+	ULONG firstSize = nFirst * kobj->recSize;
+	ULONG restSize = (n - nFirst) * kobj->recSize;
+	if (toRing)
+	{
+		kCpy( ringPtr, userPtr, firstSize);
+		kCpy( kobj->buffer, userPtr + firstSize, restSize);
+	}
+	else
+	{
+		kCpy( userPtr, ringPtr, firstSize);
+		kCpy( userPtr + firstSize, kobj->buffer, restSize);
+	}
+}
+
+K_ERR kSpscInit( K_SPSC *const kobj, ADDR const buffer, ULONG const recSize,
+		ULONG const nRecs)
+{
+	if ((kobj == NULL) || (buffer == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (recSize == 0)
+	{
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	/* power of two, so free-running indexes wrap with a mask */
+	if ((nRecs == 0) || ((nRecs & (nRecs - 1)) != 0))
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->buffer = ( BYTE*) buffer;
+	kobj->recSize = recSize;
+	kobj->nRecs = nRecs;
+	kobj->mask = nRecs - 1;
+	kobj->head = 0;
+	kobj->tail = 0;
+	kobj->readerPtr = NULL;
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.objectType = SPSC;
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+ULONG kSpscWrite( K_SPSC *const kobj, ADDR const srcPtr, ULONG const n)
+{
+	if ((kobj == NULL) || (srcPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (0);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (0);
+	}
+	ULONG head = kobj->head;
+	ULONG tail = kobj->tail;
+	/* records below tail are consumed before their slots are reused */
+	DMB
+	ULONG nWrite = kobj->nRecs - (head - tail);
+	if (nWrite > n)
+	{
+		nWrite = n;
+	}
+	if (nWrite == 0)
+	{
+		return (0);
+	}
+	kSpscCpy_( kobj, head, ( BYTE*) srcPtr, nWrite, TRUE);
+	/* records are in place before they are published */
+	DMB
+	kobj->head = head + nWrite;
+	/* head is published before readerPtr is checked */
+	DMB
+	if (kobj->readerPtr != NULL)
+	{
+		kMesgWakeReader_( &kobj->readerPtr);
+	}
+	return (nWrite);
+}
+
+K_ERR kSpscRead( K_SPSC *const kobj, ADDR const dstPtr, ULONG const n,
+		ULONG *const nReadPtr, TICK const timeout)
+{
+	if ((kobj == NULL) || (dstPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERROR);
+	}
+	if (n == 0)
+	{
+		return (K_ERR_INVALID_PARAM);
+	}
+	ULONG tail = kobj->tail;
+	ULONG nRead = kobj->head - tail;
+	if (nRead == 0)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			return (K_ERR_STREAM_EMPTY);
+		}
+		if (IS_BLOCK_ON_ISR( timeout))
+		{
+			KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		}
+		K_CR_AREA
+		K_CR_ENTER
+		TICK64 deadline = 0;
+		/* the producer cannot run between this check and parking */
+		while ((nRead = kobj->head - tail) == 0)
+		{
+			if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+					&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+							!= K_SUCCESS))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			kobj->readerPtr = runPtr;
+			runPtr->status = RECEIVING;
+			K_PEND_CTXTSWTCH
+			K_CR_EXIT
+			K_CR_ENTER
+			if (runPtr->timeOut)
+			{
+				runPtr->timeOut = FALSE;
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+				kRemoveTimeoutNode( &kobj->timeoutNode);
+		}
+		K_CR_EXIT
+	}
+	/* head is read before the records it covers */
+	DMB
+	if (nRead > n)
+	{
+		nRead = n;
+	}
+	kSpscCpy_( kobj, tail, ( BYTE*) dstPtr, nRead, FALSE);
+	/* records are out before their slots are handed back */
+	DMB
+	kobj->tail = tail + nRead;
+	if (nReadPtr != NULL)
+	{
+		*nReadPtr = nRead;
+	}
+	return (K_SUCCESS);
+}
+
+ULONG kSpscCount( K_SPSC const *const kobj)
+{
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (0);
+	}
+	return (kobj->head - kobj->tail);
+}
+
+#endif /* K_DEF_SPSC */
+
+/*******************************************************************************
+ * MPSC QUEUE
+ *
+ * Many producers, one consumer, no lock. Each cell carries a sequence
+ * number telling the position it is ready for: seq == pos, free for the
+ * producer of pos; seq == pos + 1, full for the consumer. A producer
+ * reserves a position by advancing postPos with a compare-and-swap, fills
+ * its cell and publishes it by bumping seq. A nested ISR that preempts a
+ * producer between these steps only makes the outer CAS fail and retry,
+ * or takes the next position. The consumer takes cells in position order,
+ * so a published cell after an unpublished one waits until its producer
+ * completes (and wakes the consumer, if parked).
+ *
+ * On ARMv6-M the compare-and-swap masks interrupts for a few instructions.
+ *
+ *******************************************************************************/
+#if (K_DEF_MPSC==ON)
+
+K_ERR kMpscInit( K_MPSC *const kobj, K_MPSC_CELL *const cells,
+		ULONG const nCells)
+{
+	if ((kobj == NULL) || (cells == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	/* power of two, so free-running positions wrap with a mask */
+	if ((nCells == 0) || ((nCells & (nCells - 1)) != 0))
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	for (ULONG i = 0; i < nCells; ++i)
+	{
+		cells[i].seq = i;
+		cells[i].mesgPtr = NULL;
+	}
+	kobj->cells = cells;
+	kobj->nCells = nCells;
+	kobj->mask = nCells - 1;
+	kobj->postPos = 0;
+	kobj->pendPos = 0;
+	kobj->readerPtr = NULL;
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.objectType = MPSC;
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kMpscPost( K_MPSC *const kobj, ADDR const mesgPtr)
+{
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERROR);
+	}
+	K_MPSC_CELL *cellPtr;
+	ULONG pos = kobj->postPos;
+	for (;;)
+	{
+		cellPtr = &kobj->cells[pos & kobj->mask];
+		LONG dif = ( LONG) (cellPtr->seq - pos);
+		if (dif == 0)
+		{
+			/* free: reserve it */
+			if (kAtomicCAS( &kobj->postPos, pos, pos + 1))
+			{
+				break;
+			}
+		}
+		else if (dif < 0)
+		{
+			/* still full from the previous lap */
+			return (K_ERR_MBOX_FULL);
+		}
+		/* lost the position to another producer */
+		pos = kobj->postPos;
+	}
+	cellPtr->mesgPtr = mesgPtr;
+	/* message is in place before the cell is published */
+	DMB
+	cellPtr->seq = pos + 1;
+	/* cell is published before readerPtr is checked */
+	DMB
+	if (kobj->readerPtr != NULL)
+	{
+		kMesgWakeReader_( &kobj->readerPtr);
+	}
+	return (K_SUCCESS);
+}
+
+K_ERR kMpscPend( K_MPSC *const kobj, ADDR *const recvPPtr, TICK const timeout)
+{
+	if ((kobj == NULL) || (recvPPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERROR);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERROR);
+	}
+	ULONG pos = kobj->pendPos;
+	K_MPSC_CELL *cellPtr = &kobj->cells[pos & kobj->mask];
+	if (cellPtr->seq != (pos + 1))
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			return (K_ERR_MBOX_EMPTY);
+		}
+		if (IS_BLOCK_ON_ISR( timeout))
+		{
+			KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		}
+		K_CR_AREA
+		K_CR_ENTER
+		TICK64 deadline = 0;
+		/* no producer can publish between this check and parking */
+		while (cellPtr->seq != (pos + 1))
+		{
+			/* woken by a later cell published first: only the time left */
+			if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+					&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+							!= K_SUCCESS))
+			{
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			kobj->readerPtr = runPtr;
+			runPtr->status = RECEIVING;
+			K_PEND_CTXTSWTCH
+			K_CR_EXIT
+			K_CR_ENTER
+			if (runPtr->timeOut)
+			{
+				runPtr->timeOut = FALSE;
+				K_CR_EXIT
+				return (K_ERR_TIMEOUT);
+			}
+			if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+				kRemoveTimeoutNode( &kobj->timeoutNode);
+		}
+		K_CR_EXIT
+	}
+	/* seq is read before the message it covers */
+	DMB
+	*recvPPtr = cellPtr->mesgPtr;
+	/* message is out before the cell is handed back for the next lap */
+	DMB
+	cellPtr->seq = pos + kobj->nCells;
+	kobj->pendPos = pos + 1;
+	return (K_SUCCESS);
+}
+
+#endif /* K_DEF_MPSC */
+
+/*******************************************************************************
+ * BROADCAST RING
+ *
+ * One producer, many consumers, one copy of each message. Messages are
+ * numbered by the producer cursor and message n sits in slot (n & mask).
+ * Every subscribed reader keeps the number of the next message it will
+ * read, so a slot can be overwritten only when the slowest reader is past
+ * it: the producer waits while (cursor - min(reader seq)) == nRecs.
+ * Readers and the producer wait on the same waiting queue, as RECEIVING
+ * and SENDING.
+ *
+ *******************************************************************************/
+#if (K_DEF_BCAST==ON)
+
+/* TRUE if the slowest reader still has to read the slot to be written */
+static BOOL kBcastFull_( K_BCAST const *const kobj)
+{
+	K_BCAST_READER const *readerPtr = kobj->readersPtr;
+	while (readerPtr != NULL)
+	{
+		if ((kobj->cursor - readerPtr->seq) >= kobj->nRecs)
+		{
+			return (TRUE);
+		}
+		readerPtr = readerPtr->nextPtr;
+	}
+	return (FALSE);
+}
+
+K_ERR kBcastInit( K_BCAST *const kobj, ADDR const buffer, ULONG const recSize,
+		ULONG const nRecs)
+{
+	if ((kobj == NULL) || (buffer == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if ((nRecs == 0) || ((nRecs & (nRecs - 1)) != 0))
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	if (recSize == 0)
+	{
+		return (K_ERR_INVALID_MESG_SIZE);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->buffer = ( BYTE*) buffer;
+	kobj->recSize = recSize;
+	kobj->nRecs = nRecs;
+	kobj->mask = nRecs - 1;
+	kobj->cursor = 0;
+	kobj->reserved = FALSE;
+	kobj->readersPtr = NULL;
+	kobj->nReaders = 0;
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.objectType = BCAST;
+	kListInit( &kobj->waitingQueue, "bcastq");
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastSubscribe( K_BCAST *const kobj, K_BCAST_READER *const readerPtr)
+{
+	if ((kobj == NULL) || (readerPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	if (readerPtr->bcastPtr != NULL)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	/* reads what is published from now on */
+	readerPtr->seq = kobj->cursor;
+	readerPtr->bcastPtr = kobj;
+	readerPtr->nextPtr = kobj->readersPtr;
+	kobj->readersPtr = readerPtr;
+	kobj->nReaders++;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastUnsubscribe( K_BCAST_READER *const readerPtr)
+{
+	if (readerPtr == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	K_BCAST *kobj = readerPtr->bcastPtr;
+	if (kobj == NULL)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	K_BCAST_READER **linkPPtr = &kobj->readersPtr;
+	while ((*linkPPtr != NULL) && (*linkPPtr != readerPtr))
+	{
+		linkPPtr = &(*linkPPtr)->nextPtr;
+	}
+	if (*linkPPtr == readerPtr)
+	{
+		*linkPPtr = readerPtr->nextPtr;
+		kobj->nReaders--;
+	}
+	readerPtr->nextPtr = NULL;
+	readerPtr->bcastPtr = NULL;
+	/* it may have been the slowest reader */
+	if (!kBcastFull_( kobj))
+	{
+		kMesgWake_( &kobj->waitingQueue, SENDING, 1);
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastReserve( K_BCAST *const kobj, ADDR *const slotPPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (slotPPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		K_CR_EXIT
+		return (K_ERR_INVALID_ISR_PRIMITIVE);
+	}
+	/* single producer: one reservation at a time */
+	if (kobj->reserved)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	TICK64 deadline = 0;
+	while (kBcastFull_( kobj))
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_FULL);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_BCAST_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = SENDING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	kobj->reserved = TRUE;
+	*slotPPtr = kobj->buffer + ((kobj->cursor & kobj->mask) * kobj->recSize);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastCommit( K_BCAST *const kobj)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (kobj->init == 0) || (kobj->reserved == FALSE))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kobj->reserved = FALSE;
+	kobj->cursor++;
+	/* each waiting reader is at the cursor and reads this message */
+	kMesgWake_( &kobj->waitingQueue, RECEIVING, kobj->nReaders);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastPublish( K_BCAST *const kobj, ADDR const srcPtr,
+		TICK const timeout)
+{
+	if (srcPtr == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	ADDR slotPtr;
+	K_ERR err = kBcastReserve( kobj, &slotPtr, timeout);
+	if (err)
+	{
+		return (err);
+	}
+	/* the slot is not visible to readers until committed */
+	kCpy( slotPtr, srcPtr, kobj->recSize);
+	return (kBcastCommit( kobj));
+}
+
+K_ERR kBcastAcquire( K_BCAST_READER *const readerPtr, ADDR *const slotPPtr,
+		TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((readerPtr == NULL) || (slotPPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+		K_CR_EXIT
+		return (K_ERR_INVALID_ISR_PRIMITIVE);
+	}
+	K_BCAST *kobj = readerPtr->bcastPtr;
+	if (kobj == NULL)
+	{
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	TICK64 deadline = 0;
+	while (readerPtr->seq == kobj->cursor)
+	{
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_STREAM_EMPTY);
+		}
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+#if (K_DEF_BCAST_ENQ==K_DEF_ENQ_FIFO)
+		kTCBQEnq( &kobj->waitingQueue, runPtr);
+#else
+		kTCBQEnqByPrio( &kobj->waitingQueue, runPtr);
+#endif
+		runPtr->waitNeed = 1;
+		runPtr->status = RECEIVING;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+	*slotPPtr = kobj->buffer + ((readerPtr->seq & kobj->mask) * kobj->recSize);
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kBcastRelease( K_BCAST_READER *const readerPtr)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((readerPtr == NULL) || (readerPtr->bcastPtr == NULL))
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	K_BCAST *kobj = readerPtr->bcastPtr;
+	if (readerPtr->seq == kobj->cursor)
+	{
 		K_CR_EXIT
-		return (K_ERR_MESG_CPY);
+		return (K_ERROR);
 	}
-	/*succeded */
-	kobj->mesgCnt++;
-	/*was empty? there're waiting readers */
-	if ((kobj->mesgCnt == 1) && (kobj->waitingQueue.size > 0))
+	/* only a reader a full ring behind holds the producer back */
+	BOOL gating = ((kobj->cursor - readerPtr->seq) >= kobj->nRecs);
+	readerPtr->seq++;
+	if (gating && !kBcastFull_( kobj))
+	{
+		kMesgWake_( &kobj->waitingQueue, SENDING, 1);
+	}
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+ULONG kBcastPending( K_BCAST_READER const *const readerPtr)
+{
+	K_BCAST const *kobj = readerPtr->bcastPtr;
+	if (kobj == NULL)
+	{
+		return (0);
+	}
+	return (kobj->cursor - readerPtr->seq);
+}
+
+#endif /* K_DEF_BCAST */
+
+/*******************************************************************************
+ * REFERENCE-COUNTED MESSAGES
+ *******************************************************************************/
+#if (K_DEF_MSGREF==ON)
+
+#define MSG_HDR(msgPtr) ((struct kMsgHdr*) (msgPtr) - 1)
+
+ADDR kMsgAlloc( K_MEM *const memPtr)
+{
+	if (IS_NULL_PTR( memPtr))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (NULL);
+	}
+	if (memPtr->blkSize <= K_MSG_HDR_SIZE)
+	{
+		return (NULL);
+	}
+	struct kMsgHdr *hdrPtr = ( struct kMsgHdr*) kMemAlloc( memPtr);
+	if (hdrPtr == NULL)
+	{
+		return (NULL);
+	}
+	hdrPtr->memPtr = memPtr;
+	hdrPtr->refCnt = 1;
+	return ((ADDR) (hdrPtr + 1));
+}
+
+K_ERR kMsgRef( ADDR const msgPtr)
+{
+	if (IS_NULL_PTR( msgPtr))
 	{
-		K_TCB *freeTaskPtr;
-		kTCBQDeq( &kobj->waitingQueue, &freeTaskPtr);
-		kTCBQEnq( &readyQueue[freeTaskPtr->priority], freeTaskPtr);
-		freeTaskPtr->status = READY;
-		if (freeTaskPtr->priority < runPtr->priority)
+		return (K_ERR_OBJ_NULL);
+	}
+	struct kMsgHdr *hdrPtr = MSG_HDR( msgPtr);
+	ULONG cnt;
+	do
+	{
+		cnt = hdrPtr->refCnt;
+		/* already released */
+		if (cnt == 0)
 		{
-			K_PEND_CTXTSWTCH
+			return (K_ERROR);
 		}
+	} while (!kAtomicCAS( &hdrPtr->refCnt, cnt, cnt + 1));
+	return (K_SUCCESS);
+}
+
+K_ERR kMsgUnref( ADDR const msgPtr)
+{
+	if (IS_NULL_PTR( msgPtr))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	struct kMsgHdr *hdrPtr = MSG_HDR( msgPtr);
+	ULONG cnt;
+	do
+	{
+		cnt = hdrPtr->refCnt;
+		if (cnt == 0)
+		{
+			return (K_ERROR);
+		}
+	} while (!kAtomicCAS( &hdrPtr->refCnt, cnt, cnt - 1));
+	/* last reference: back to the pool */
+	if (cnt == 1)
+	{
+		return (kMemFree( hdrPtr->memPtr, hdrPtr));
 	}
-	K_CR_EXIT
 	return (K_SUCCESS);
 }
+
+ULONG kMsgRefCount( ADDR const msgPtr)
+{
+	if (IS_NULL_PTR( msgPtr))
+	{
+		return (0);
+	}
+	return (MSG_HDR( msgPtr)->refCnt);
+}
+
+/*
+ * Posting helpers add a reference on behalf of the receiver, and drop it if
+ * the post fails. The sender keeps its own reference and releases it when
+ * done fanning out. To hand the sender's reference over instead, post with
+ * kQueuePost()/kMboxPost().
+ */
+#if (K_DEF_QUEUE==ON)
+K_ERR kMsgQueuePost( K_QUEUE *const kobj, ADDR const msgPtr,
+		TICK const timeout)
+{
+	K_ERR err = kMsgRef( msgPtr);
+	if (err != K_SUCCESS)
+	{
+		return (err);
+	}
+	err = kQueuePost( kobj, msgPtr, timeout);
+	if (err != K_SUCCESS)
+	{
+		kMsgUnref( msgPtr);
+	}
+	return (err);
+}
 #endif
 
-#if (K_DEF_FUNC_STREAM_MESGCOUNT==ON)
-K_ERR kStreamGetMesgCount( K_STREAM *const kobj, UINT *const mesgCntPtr)
+#if (K_DEF_MBOX==ON)
+K_ERR kMsgMboxPost( K_MBOX *const kobj, ADDR const msgPtr, TICK const timeout)
+{
+	K_ERR err = kMsgRef( msgPtr);
+	if (err != K_SUCCESS)
+	{
+		return (err);
+	}
+	err = kMboxPost( kobj, msgPtr, timeout);
+	if (err != K_SUCCESS)
+	{
+		kMsgUnref( msgPtr);
+	}
+	return (err);
+}
+#endif
+
+#endif /* K_DEF_MSGREF */
+
+/*******************************************************************************
+ * PUBLISH-SUBSCRIBE
+ *
+ * A topic keeps a list of subscribers, each one a Queue and an optional
+ * filter. kPublish() posts the same message, by pointer, to every queue
+ * whose filter takes it, adding a reference per delivery; each subscriber
+ * kMsgUnref()s it when done, and the block returns to its pool on the last
+ * one. Delivery never blocks: a full queue counts a drop for its
+ * subscriber. Subscriber records are provided by the caller.
+ *******************************************************************************/
+#if (K_DEF_PUBSUB==ON)
+
+K_ERR kTopicInit( K_TOPIC *const kobj, STRING const name)
 {
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
 	K_CR_AREA
-	if (kobj)
+	K_CR_ENTER
+	kobj->name = name;
+	kobj->subsPtr = NULL;
+	kobj->nSubs = 0;
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kSubscribe( K_TOPIC *const kobj, K_SUBSCRIBER *const subPtr,
+		K_QUEUE *const queuePtr, MSGFILTER const filter,
+		ADDR const filterArgsPtr)
+{
+	if ((kobj == NULL) || (subPtr == NULL) || (queuePtr == NULL))
 	{
-		K_CR_ENTER
-		*mesgCntPtr = kobj->mesgCnt;
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	if (subPtr->topicPtr != NULL)
+	{
+		/* already subscribed */
 		K_CR_EXIT
-		return (K_SUCCESS);
+		return (K_ERROR);
 	}
-	return (K_ERR_OBJ_NULL);
+	subPtr->queuePtr = queuePtr;
+	subPtr->filter = filter;
+	subPtr->filterArgsPtr = filterArgsPtr;
+	subPtr->nDropped = 0;
+	subPtr->topicPtr = kobj;
+	subPtr->nextPtr = kobj->subsPtr;
+	kobj->subsPtr = subPtr;
+	kobj->nSubs++;
+	K_CR_EXIT
+	return (K_SUCCESS);
 }
-#endif
 
-#endif /*K_DEF_STREAM*/
+K_ERR kUnsubscribe( K_SUBSCRIBER *const subPtr)
+{
+	if (subPtr == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	K_TOPIC *topicPtr = subPtr->topicPtr;
+	if (topicPtr == NULL)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	K_SUBSCRIBER **linkPPtr = &topicPtr->subsPtr;
+	while ((*linkPPtr != NULL) && (*linkPPtr != subPtr))
+	{
+		linkPPtr = &(*linkPPtr)->nextPtr;
+	}
+	if (*linkPPtr == subPtr)
+	{
+		*linkPPtr = subPtr->nextPtr;
+		topicPtr->nSubs--;
+	}
+	subPtr->nextPtr = NULL;
+	subPtr->topicPtr = NULL;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+/*
+ * The list is walked within a critical region, so subscriptions cannot
+ * change under it; filters run there too and must be short.
+ */
+K_ERR kPublish( K_TOPIC *const kobj, ADDR const msgPtr,
+		ULONG *const nDeliveredPtr)
+{
+	if ((kobj == NULL) || (msgPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	/* the publisher holds a reference while publishing */
+	if (kMsgRefCount( msgPtr) == 0)
+	{
+		return (K_ERROR);
+	}
+	ULONG nDelivered = 0;
+	K_CR_AREA
+	K_CR_ENTER
+	for (K_SUBSCRIBER *subPtr = kobj->subsPtr; subPtr != NULL;
+			subPtr = subPtr->nextPtr)
+	{
+		if ((subPtr->filter != NULL)
+				&& !subPtr->filter( msgPtr, subPtr->filterArgsPtr))
+		{
+			continue;
+		}
+		if (kMsgQueuePost( subPtr->queuePtr, msgPtr, K_NO_WAIT) == K_SUCCESS)
+		{
+			nDelivered++;
+		}
+		else
+		{
+			subPtr->nDropped++;
+		}
+	}
+	K_CR_EXIT
+	if (nDeliveredPtr != NULL)
+	{
+		*nDeliveredPtr = nDelivered;
+	}
+	return (K_SUCCESS);
+}
+
+#endif /* K_DEF_PUBSUB */
 
 #if (K_DEF_PDMESG == ON)
 
@@ -1029,108 +3706,184 @@ K_ERR kStreamGetMesgCount( K_STREAM *const kobj, UINT *const mesgCntPtr)
  * Consumer:
  * fetch - read - drop
  *
+ * Each buffer has a state word: the number of readers holding it in the
+ * low half, PD_WRITING while a writer holds it and PD_NEWEST while it is
+ * the last one pumped. A buffer is free when its state is 0. States are
+ * only changed with atomic operations, so no method disables interrupts,
+ * and with nBufs >= (readers + 2) a writer always finds a free buffer.
  **/
 
-K_ERR kPDMesgInit( K_PDMESG *const kobj, K_MEM *const memCtrlPtr,
-		K_PDBUF *bufPool, BYTE nBufs)
+#define PD_NREADERS (0x0000FFFFUL)
+#define PD_WRITING  (0x00010000UL)
+#define PD_NEWEST   (0x00020000UL)
+
+/* TRUE if bufPtr is one of the buffers of kobj */
+static inline BOOL kPDMesgOwns_( K_PDMESG const *const kobj,
+		K_PDBUF const *const bufPtr)
 {
-	K_CR_AREA
-	K_CR_ENTER
-	K_ERR err = K_ERROR;
-	kobj->memCtrlPtr = memCtrlPtr;
-	err = kMemInit( kobj->memCtrlPtr, bufPool, sizeof(K_PDBUF), nBufs);
-	if (!err)
+	return ((bufPtr >= kobj->bufPool) && (bufPtr < kobj->bufPool + kobj->nBufs));
+}
+
+K_ERR kPDMesgInit( K_PDMESG *const kobj, K_PDBUF *const bufPool,
+		ADDR const dataPool, ULONG const dataSize, ULONG const nBufs)
+{
+	if ((kobj == NULL) || (bufPool == NULL) || (dataPool == NULL))
 	{
-		/* nobody is using anything yet */
-		kobj->currBufPtr = NULL;
-		kobj->init = TRUE;
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
 	}
-	K_CR_EXIT
-	return (err);
+	/* one being written, the newest, and one being read */
+	if (nBufs < 3)
+	{
+		return (K_ERR_INVALID_QUEUE_SIZE);
+	}
+	if (dataSize == 0)
+	{
+		return (K_ERR_PDBUF_SIZE);
+	}
+	for (ULONG i = 0; i < nBufs; i++)
+	{
+		bufPool[i].dataPtr = ( BYTE*) dataPool + (i * dataSize);
+		bufPool[i].dataSize = 0;
+		bufPool[i].bufSize = dataSize;
+		bufPool[i].state = 0;
+	}
+	kobj->bufPool = bufPool;
+	kobj->nBufs = nBufs;
+	/* nobody is using anything yet */
+	kobj->currIdx = 0;
+	kobj->failReserve = 0;
+	kobj->init = TRUE;
+	return (K_SUCCESS);
 }
 
 K_PDBUF* kPDMesgReserve( K_PDMESG *const kobj)
 {
-
-	K_CR_AREA
-	K_CR_ENTER
-	K_PDBUF *allocPtr = NULL;
-	if ((kobj->currBufPtr == NULL))
+	if ((kobj == NULL) || (!kobj->init))
 	{
-		allocPtr = kMemAlloc( kobj->memCtrlPtr);
+		return (NULL);
 	}
-	else if ((kobj->currBufPtr->nUsers == 0) && (kobj->currBufPtr != NULL))
+	for (ULONG i = 0; i < kobj->nBufs; i++)
 	{
-		allocPtr = kobj->currBufPtr;
+		K_PDBUF *bufPtr = &kobj->bufPool[i];
+		if ((bufPtr->state == 0) && kAtomicCAS( &bufPtr->state, 0, PD_WRITING))
+		{
+			return (bufPtr);
+		}
 	}
+	/* never waits: too few buffers for the readers holding them */
+	kAtomicAdd( &kobj->failReserve, 1);
+	return (NULL);
+}
 
-	if (!allocPtr)
+K_ERR kPDBufWrite( K_PDBUF *const bufPtr, ADDR const srcPtr,
+		ULONG const dataSize)
+{
+	if ((bufPtr == NULL) || (srcPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if (bufPtr->state != PD_WRITING)
 	{
-		kobj->failReserve++;
+		return (K_ERROR);
 	}
-	K_CR_EXIT
-	return (allocPtr);
+	if (dataSize > bufPtr->bufSize)
+	{
+		return (K_ERR_PDBUF_SIZE);
+	}
+	kCpy( bufPtr->dataPtr, srcPtr, dataSize);
+	bufPtr->dataSize = dataSize;
+	return (K_SUCCESS);
 }
 
-K_ERR kPDMesgPump( K_PDMESG *const kobj, K_PDBUF *const buffPtr)
+K_ERR kPDMesgPump( K_PDMESG *const kobj, K_PDBUF *const bufPtr)
 {
-	K_CR_AREA
+	if ((kobj == NULL) || (bufPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
 	if (!kobj->init)
+	{
 		return (K_ERR_OBJ_NOT_INIT);
-	/* first pump will skip this if */
-	K_CR_ENTER
-	if ((kobj->currBufPtr != NULL) && (kobj->currBufPtr != buffPtr)
-			&& (kobj->currBufPtr->nUsers == 0))
-	{ /*deallocate curr buf if not null and not used */
-		K_ERR err = kMemFree( kobj->memCtrlPtr, kobj->currBufPtr);
-		if (err)
-		{
-			K_CR_EXIT
-			return (err);
-		}
 	}
-	/* replace current buffer */
-	kobj->currBufPtr = buffPtr;
-	K_CR_EXIT
+	if (!kPDMesgOwns_( kobj, bufPtr) || (bufPtr->state != PD_WRITING))
+	{
+		return (K_ERROR);
+	}
+	/* the message is complete before the buffer can be fetched */
+	DMB
+	/* no reader takes a buffer without PD_NEWEST, so a plain store will do */
+	bufPtr->state = PD_NEWEST;
+	ULONG idx = ( ULONG) (bufPtr - kobj->bufPool) + 1;
+	ULONG oldIdx;
+	do
+	{
+		oldIdx = kobj->currIdx;
+	} while (!kAtomicCAS( &kobj->currIdx, oldIdx, idx));
+	if (oldIdx != 0)
+	{
+		/* the replaced buffer is free as soon as it has no readers */
+		kAtomicAdd( &kobj->bufPool[oldIdx - 1].state, -( long) PD_NEWEST);
+	}
 	return (K_SUCCESS);
 }
 
 K_PDBUF* kPDMesgFetch( K_PDMESG *const kobj)
 {
-	K_CR_AREA
-	if (!kobj->init)
+	if ((kobj == NULL) || (!kobj->init))
+	{
 		return (NULL);
-	if (kobj->currBufPtr)
+	}
+	while (1)
 	{
-		K_CR_ENTER
-		K_PDBUF *ret = kobj->currBufPtr;
-		kobj->currBufPtr->nUsers++;
-		K_CR_EXIT
-		return (ret);
+		ULONG idx = kobj->currIdx;
+		if (idx == 0)
+		{
+			return (NULL);
+		}
+		K_PDBUF *bufPtr = &kobj->bufPool[idx - 1];
+		ULONG state = bufPtr->state;
+		/* a replaced buffer may be free already; retry with the newest */
+		if ((state & PD_NEWEST)
+				&& kAtomicCAS( &bufPtr->state, state, state + 1))
+		{
+			DMB
+			return (bufPtr);
+		}
 	}
-	return (NULL);
+}
+
+K_ERR kPDBufRead( K_PDBUF *const bufPtr, ADDR const destPtr)
+{
+	if ((bufPtr == NULL) || (destPtr == NULL))
+	{
+		return (K_ERR_OBJ_NULL);
+	}
+	if ((bufPtr->state & PD_NREADERS) == 0)
+	{
+		return (K_ERROR);
+	}
+	kCpy( destPtr, bufPtr->dataPtr, bufPtr->dataSize);
+	return (K_SUCCESS);
 }
 
 K_ERR kPDMesgDrop( K_PDMESG *const kobj, K_PDBUF *const bufPtr)
 {
-	if (!kobj->init)
+	if ((kobj == NULL) || (bufPtr == NULL))
+	{
 		return (K_ERR_OBJ_NULL);
-	K_ERR err = 0;
-	if (bufPtr)
+	}
+	if (!kobj->init)
 	{
-		K_CR_AREA
-		K_CR_ENTER
-		if (bufPtr->nUsers > 0)
-			bufPtr->nUsers--;
-		/* deallocate if not used and not the curr buf */
-		if ((bufPtr->nUsers == 0) && (kobj->currBufPtr != bufPtr))
-		{
-			err = kMemFree( kobj->memCtrlPtr, bufPtr);
-		}
-		K_CR_EXIT
-		return (err);
+		return (K_ERR_OBJ_NOT_INIT);
 	}
-	return (K_ERR_OBJ_NULL);
+	if (!kPDMesgOwns_( kobj, bufPtr) || ((bufPtr->state & PD_NREADERS) == 0))
+	{
+		return (K_ERROR);
+	}
+	/* the last reader of a replaced buffer frees it */
+	kAtomicAdd( &bufPtr->state, -1);
+	return (K_SUCCESS);
 }
 
 #endif
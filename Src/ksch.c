@@ -90,6 +90,25 @@ K_ERR kTCBQEnq( K_TCBQ *const kobj, K_TCB *const tcbPtr)
     return (err);
 }
 
+/* enqueues at the head: the task is the next one dequeued */
+K_ERR kTCBQJam( K_TCBQ *const kobj, K_TCB *const tcbPtr)
+{
+    K_CR_AREA
+    K_CR_ENTER
+    if (kobj == NULL || tcbPtr == NULL)
+    {
+        kErrHandler( FAULT_OBJ_NULL);
+    }
+    K_ERR err = kListAddHead( kobj, &(tcbPtr->tcbNode));
+    if (err == 0)
+    {
+        if (kobj == &readyQueue[tcbPtr->priority])
+            readyQBitMask |= 1 << tcbPtr->priority;
+    }
+    K_CR_EXIT
+    return (err);
+}
+
 K_ERR kTCBQDeq( K_TCBQ *const kobj, K_TCB **const tcbPPtr)
 {
     if (kobj == NULL)
@@ -137,6 +156,32 @@ K_ERR kTCBQRem( K_TCBQ *const kobj, K_TCB **const tcbPPtr)
     return (K_SUCCESS);
 }
 
+/* changes the effective priority of a task; a ready task moves to the
+ * ready queue of its new priority */
+VOID kTCBSetPrio( K_TCB *const tcbPtr, PRIO const prio)
+{
+    K_CR_AREA
+    K_CR_ENTER
+    if (tcbPtr->priority != prio)
+    {
+        if (tcbPtr->status == READY)
+        {
+            K_TCB *remPtr = tcbPtr;
+            PRIO oldPrio = tcbPtr->priority;
+            kTCBQRem( &readyQueue[oldPrio], &remPtr);
+            if (readyQueue[oldPrio].size == 0)
+                readyQBitMask &= ~(1U << oldPrio);
+            tcbPtr->priority = prio;
+            kTCBQEnq( &readyQueue[prio], tcbPtr);
+        }
+        else
+        {
+            tcbPtr->priority = prio;
+        }
+    }
+    K_CR_EXIT
+}
+
 K_TCB* kTCBQPeek( K_TCBQ *const kobj)
 {
     if (kobj == NULL)
@@ -291,8 +336,12 @@ K_ERR kCreateTask( K_TASK_HANDLE *taskHandlePtr, TASKENTRY const taskFuncPtr,
         kassert( kInitTcb_(IdleTask, idleStack, IDLE_STACKSIZE) == K_SUCCESS);
 
         tcbs[pPid].priority = idleTaskPrio;
-#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) )
+#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) \
+        || (K_DEF_CHANNEL==ON) )
         tcbs[pPid].realPrio = idleTaskPrio;
+#endif
+#if (K_DEF_MUTEX_PRIO_INH==ON)
+        tcbs[pPid].mutexPrio = idleTaskPrio;
 #endif
         tcbs[pPid].taskName = "IdleTask";
         tcbs[pPid].runToCompl = FALSE;
@@ -308,8 +357,12 @@ K_ERR kCreateTask( K_TASK_HANDLE *taskHandlePtr, TASKENTRY const taskFuncPtr,
                 kInitTcb_(TimerHandlerTask, timerHandlerStack, TIMHANDLER_STACKSIZE) == K_SUCCESS);
 
         tcbs[pPid].priority = 0;
-#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) )
+#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) \
+        || (K_DEF_CHANNEL==ON) )
         tcbs[pPid].realPrio = 0;
+#endif
+#if (K_DEF_MUTEX_PRIO_INH==ON)
+        tcbs[pPid].mutexPrio = 0;
 #endif
         tcbs[pPid].taskName = "TimHandlerTask";
         tcbs[pPid].runToCompl = TRUE;
@@ -329,8 +382,12 @@ K_ERR kCreateTask( K_TASK_HANDLE *taskHandlePtr, TASKENTRY const taskFuncPtr,
             kErrHandler( FAULT_TASK_INVALID_PRIO);
         }
         tcbs[pPid].priority = priority;
-#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) )
+#if ( (K_DEF_FUNC_DYNAMIC_PRIO==ON) || (K_DEF_MUTEX_PRIO_INH==ON) \
+        || (K_DEF_CHANNEL==ON) )
         tcbs[pPid].realPrio = priority;
+#endif
+#if (K_DEF_MUTEX_PRIO_INH==ON)
+        tcbs[pPid].mutexPrio = priority;
 #endif
         tcbs[pPid].taskName = taskName;
 
@@ -507,9 +564,10 @@ BOOL kTickHandler( VOID)
         runPtr->busyWaitTime -= 1U;
     }
 #endif
-    if (runTime.globalTick == K_TICK_TYPE_MAX)
+    /* globalTick wraps naturally; nWraps is the upper half of the
+       64-bit monotonic time (see kTimeNow64()) */
+    if (runTime.globalTick == 0U)
     {
-        runTime.globalTick = 0U;
         runTime.nWraps += 1U;
     }
 
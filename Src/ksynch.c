@@ -13,6 +13,8 @@
  *					o Direct Task Signals (Binary Semaphore and Flags)
  *					o Events (Sleep/Wake, Condition Variables and Event Flags)
  *					o Semaphores (Counter, Binary and Mutexes)
+ *					o Sequence Locks (one writer, many lock-free readers)
+ *					o Wait Sets (block on any of several objects)
  *
  *  Notes: Blocking methods cannot be issued from ISR
  *  	   There is no distinct method for ISRs
@@ -291,6 +293,9 @@ K_ERR kEventInit( K_EVENT *const kobj)
 	kobj->timeoutNode.nextPtr = NULL;
 	kobj->timeoutNode.timeout = 0;
  	kobj->timeoutNode.objectType = EVENT;
+#if (K_DEF_WAITSET==ON)
+	kobj->waitSetPtr = NULL;
+#endif
 #if (K_DEF_EVENT_FLAGS==ON)
 	kobj->eventFlags = 0UL;
 #endif
@@ -371,6 +376,7 @@ K_ERR kEventWake( K_EVENT *const kobj)
 		K_CR_EXIT
 		return (K_ERR_OBJ_NOT_INIT);
 	}
+	K_WAITSET_NOTIFY( kobj);
 	if (kobj->waitingQueue.size == 0)
 	{
 		K_CR_EXIT
@@ -403,6 +409,7 @@ K_ERR kEventSignal( K_EVENT *const kobj)
 		K_CR_EXIT
 		return (K_ERR_OBJ_NULL);
 	}
+	K_WAITSET_NOTIFY( kobj);
 	if (kobj->waitingQueue.size == 0)
 		err = (K_ERR_EMPTY_WAITING_QUEUE);
 	K_CR_EXIT
@@ -649,6 +656,9 @@ K_ERR kSemaInit( K_SEMA *const kobj, const LONG value)
 	kobj->timeoutNode.nextPtr = NULL;
 	kobj->timeoutNode.timeout = 0;
  	kobj->timeoutNode.objectType = SEMAPHORE;
+#if (K_DEF_WAITSET==ON)
+	kobj->waitSetPtr = NULL;
+#endif
 	K_CR_EXIT
 	return (K_SUCCESS);
 }
@@ -748,6 +758,11 @@ K_ERR kSemaSignal( K_SEMA *const kobj)
 			return (err);
 		}
 	}
+	else
+	{
+		/* no waiter took it */
+		K_WAITSET_NOTIFY( kobj);
+	}
 	K_CR_EXIT
 	return (K_SUCCESS);
 }
@@ -814,6 +829,11 @@ K_ERR kMutexLock( K_MUTEX *const kobj, TICK timeout)
 			return (K_ERR_MUTEX_LOCKED);
 		}
 #if(K_DEF_MUTEX_PRIO_INH==(ON))
+		/* recorded apart, so other boosts do not drop it */
+		if (kobj->ownerPtr->mutexPrio > runPtr->priority)
+		{
+			kobj->ownerPtr->mutexPrio = runPtr->priority;
+		}
 		if (kobj->ownerPtr->priority > runPtr->priority)
 		{
 			/* mutex owner has lower priority than the tried-to-lock-task
@@ -893,6 +913,7 @@ K_ERR kMutexUnlock( K_MUTEX *const kobj)
 #if (K_DEF_MUTEX_PRIO_INH==(ON))
 		/* restore owner priority */
 		kobj->ownerPtr->priority = kobj->ownerPtr->realPrio;
+		kobj->ownerPtr->mutexPrio = kobj->ownerPtr->realPrio;
 #endif
 		tcbPtr = kobj->ownerPtr;
 		kobj->ownerPtr = NULL;
@@ -911,6 +932,7 @@ K_ERR kMutexUnlock( K_MUTEX *const kobj)
 		{
 			runPtr->priority = runPtr->realPrio;
 		}
+		runPtr->mutexPrio = runPtr->realPrio;
 #endif
 		if (!kReadyCtxtSwtch( tcbPtr))
 		{
@@ -954,3 +976,399 @@ K_ERR kMutexQuery( K_MUTEX *const kobj)
 }
 
 #endif /* mutex */
+
+#if (K_DEF_SEQLOCK==ON)
+/******************************************************************************
+ * SEQUENCE LOCK
+ ******************************************************************************
+ * The writer makes the sequence odd, updates the data and makes it even
+ * again. A reader copies the data between two reads of the sequence and
+ * retries unless both are the same even number.
+ *
+ * An odd sequence seen by a reader means the writer has been preempted:
+ * from an ISR it cannot finish before the ISR returns, and from a task it
+ * will not run while the reader spins, so the reader gives up or sleeps.
+ *****************************************************************************/
+
+K_ERR kSeqLockInit( K_SEQLOCK *const kobj, ADDR const dataPtr,
+		ULONG const size)
+{
+	if ((kobj == NULL) || (dataPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (size == 0)
+	{
+		return (K_ERR_INVALID_PARAM);
+	}
+	kobj->seq = 0;
+	kobj->dataPtr = dataPtr;
+	kobj->size = size;
+	kobj->init = TRUE;
+	return (K_SUCCESS);
+}
+
+K_ERR kSeqLockWrite( K_SEQLOCK *const kobj, ADDR const srcPtr)
+{
+	if ((kobj == NULL) || (srcPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	kobj->seq++;
+	DMB
+	kCpy( kobj->dataPtr, srcPtr, kobj->size);
+	DMB
+	kobj->seq++;
+	return (K_SUCCESS);
+}
+
+K_ERR kSeqLockRead( K_SEQLOCK *const kobj, ADDR const dstPtr)
+{
+	if ((kobj == NULL) || (dstPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	while (1)
+	{
+		ULONG seq = kobj->seq;
+		if (seq & 1UL)
+		{
+			if (kIsISR())
+			{
+				return (K_ERR_SEQLOCK_BUSY);
+			}
+			kSleep( 1);
+			continue;
+		}
+		DMB
+		kCpy( dstPtr, kobj->dataPtr, kobj->size);
+		DMB
+		if (kobj->seq == seq)
+		{
+			return (K_SUCCESS);
+		}
+	}
+}
+
+#endif /* K_DEF_SEQLOCK */
+
+#if (K_DEF_WAITSET==ON)
+/*******************************************************************************
+ * WAIT SETS
+ *******************************************************************************/
+/*
+ * A task has a single list node, so it cannot sit in several waiting queues.
+ * Instead, objects added to a set point back to it, and whenever one may
+ * have become ready (a post, a send, a signal) it marks its bit and readies
+ * the task blocked in kWaitAny(). That task then takes from the object it
+ * was given with K_NO_WAIT; as a waiter of the object itself could have been
+ * faster, a NO_WAIT take can still fail, and the task just waits again.
+ * Queues, Streams, Pipes and Semaphores are checked for their state; Events
+ * keep no state, so a signal is latched on the set until reported.
+ * kWaitSetRemove() and a new kWaitSetInit() clear the back-pointers, so a
+ * set must not go away while objects still point to it.
+ */
+
+/* TRUE if a take with K_NO_WAIT would succeed now */
+static BOOL kWaitSetItemReady_( struct kWaitSetItem const *const itemPtr)
+{
+	switch (itemPtr->objectType)
+	{
+#if (K_DEF_QUEUE==ON)
+	case QUEUE:
+		return (((K_QUEUE*) itemPtr->objPtr)->countItems > 0);
+#endif
+#if (K_DEF_STREAM==ON)
+	case STREAM:
+	{
+		K_STREAM const *streamPtr = ( K_STREAM*) itemPtr->objPtr;
+#if (K_DEF_FUNC_STREAM_ZEROCOPY==ON)
+		if (streamPtr->acquired)
+		{
+			return (FALSE);
+		}
+#endif
+		return (streamPtr->mesgCnt > 0);
+	}
+#endif
+#if (K_DEF_PIPE==ON)
+	case PIPE:
+		return (((K_PIPE*) itemPtr->objPtr)->recCnt > 0);
+#endif
+#if (K_DEF_SEMA==ON)
+	case SEMAPHORE:
+		return (((K_SEMA*) itemPtr->objPtr)->value > 0);
+#endif
+	default:
+		return (FALSE);
+	}
+}
+
+/* the back-pointer and the bit of a member, FALSE if the type cannot be one */
+static BOOL kWaitSetLinks_( K_OBJ_TYPE const objectType, ADDR const objPtr,
+		struct kWaitSet ***const setPPtrPtr, ULONG **const bitPtrPtr)
+{
+	switch (objectType)
+	{
+#if (K_DEF_QUEUE==ON)
+	case QUEUE:
+		*setPPtrPtr = &(( K_QUEUE*) objPtr)->waitSetPtr;
+		*bitPtrPtr = &(( K_QUEUE*) objPtr)->waitSetBit;
+		return (TRUE);
+#endif
+#if (K_DEF_STREAM==ON)
+	case STREAM:
+		*setPPtrPtr = &(( K_STREAM*) objPtr)->waitSetPtr;
+		*bitPtrPtr = &(( K_STREAM*) objPtr)->waitSetBit;
+		return (TRUE);
+#endif
+#if (K_DEF_PIPE==ON)
+	case PIPE:
+		*setPPtrPtr = &(( K_PIPE*) objPtr)->waitSetPtr;
+		*bitPtrPtr = &(( K_PIPE*) objPtr)->waitSetBit;
+		return (TRUE);
+#endif
+#if (K_DEF_SEMA==ON)
+	case SEMAPHORE:
+		*setPPtrPtr = &(( K_SEMA*) objPtr)->waitSetPtr;
+		*bitPtrPtr = &(( K_SEMA*) objPtr)->waitSetBit;
+		return (TRUE);
+#endif
+#if (K_DEF_EVENT==ON)
+	case EVENT:
+		*setPPtrPtr = &(( K_EVENT*) objPtr)->waitSetPtr;
+		*bitPtrPtr = &(( K_EVENT*) objPtr)->waitSetBit;
+		return (TRUE);
+#endif
+	default:
+		return (FALSE);
+	}
+}
+
+/* clears the back-pointer of item i, if it still points to the set */
+static VOID kWaitSetDetach_( K_WAIT_SET *const kobj, ULONG const i)
+{
+	struct kWaitSet **setPPtr = NULL;
+	ULONG *bitPtr = NULL;
+	if (kWaitSetLinks_( kobj->items[i].objectType, kobj->items[i].objPtr,
+			&setPPtr, &bitPtr) && (*setPPtr == kobj))
+	{
+		*setPPtr = NULL;
+		*bitPtr = 0;
+	}
+}
+
+K_ERR kWaitSetInit( K_WAIT_SET *const kobj)
+{
+	if (kobj == NULL)
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	/* a set initialised again lets its members go; on a first init the
+	 * fields are whatever the memory held, hence the bound */
+	if ((kobj->init == TRUE) && (kobj->nItems <= K_DEF_WAITSET_MAX))
+	{
+		for (ULONG i = 0; i < kobj->nItems; ++i)
+		{
+			kWaitSetDetach_( kobj, i);
+		}
+	}
+	kobj->nItems = 0;
+	kobj->signalled = 0;
+	kobj->ownerPtr = NULL;
+	kobj->timeoutNode.nextPtr = NULL;
+	kobj->timeoutNode.prevPtr = NULL;
+	kobj->timeoutNode.timeout = 0;
+	kobj->timeoutNode.objectType = WAITSET;
+	kobj->init = TRUE;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kWaitSetAdd( K_WAIT_SET *const kobj, K_OBJ_TYPE const objectType,
+		ADDR const objPtr)
+{
+	if ((kobj == NULL) || (objPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	struct kWaitSet **setPPtr = NULL;
+	ULONG *bitPtr = NULL;
+	if (!kWaitSetLinks_( objectType, objPtr, &setPPtr, &bitPtr))
+	{
+		return (K_ERR_INVALID_PARAM);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	if (kobj->nItems >= K_DEF_WAITSET_MAX)
+	{
+		K_CR_EXIT
+		return (K_ERR_INVALID_PARAM);
+	}
+	/* an object points back to one set only */
+	if (*setPPtr != NULL)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kobj->items[kobj->nItems].objectType = objectType;
+	kobj->items[kobj->nItems].objPtr = objPtr;
+	*bitPtr = (1UL << kobj->nItems);
+	*setPPtr = kobj;
+	kobj->nItems++;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+K_ERR kWaitSetRemove( K_WAIT_SET *const kobj, ADDR const objPtr)
+{
+	if ((kobj == NULL) || (objPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	K_CR_AREA
+	K_CR_ENTER
+	ULONG i = 0;
+	while ((i < kobj->nItems) && (kobj->items[i].objPtr != objPtr))
+	{
+		i++;
+	}
+	if (i == kobj->nItems)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	kWaitSetDetach_( kobj, i);
+	/* the members after it move down one index, and so do their bits */
+	for (ULONG j = i + 1; j < kobj->nItems; ++j)
+	{
+		struct kWaitSet **setPPtr = NULL;
+		ULONG *bitPtr = NULL;
+		kobj->items[j - 1] = kobj->items[j];
+		kWaitSetLinks_( kobj->items[j - 1].objectType,
+				kobj->items[j - 1].objPtr, &setPPtr, &bitPtr);
+		*bitPtr = (1UL << (j - 1));
+	}
+	ULONG below = (1UL << i) - 1UL;
+	kobj->signalled = (kobj->signalled & below)
+			| ((kobj->signalled >> 1) & ~below);
+	kobj->nItems--;
+	K_CR_EXIT
+	return (K_SUCCESS);
+}
+
+VOID kWaitSetNotify( K_WAIT_SET *const kobj, ULONG const bit)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	kobj->signalled |= bit;
+	K_TCB *ownerPtr = kobj->ownerPtr;
+	if (ownerPtr != NULL)
+	{
+		kobj->ownerPtr = NULL;
+		kReadyCtxtSwtch( ownerPtr);
+	}
+	K_CR_EXIT
+}
+
+K_ERR kWaitAny( K_WAIT_SET *const kobj, ULONG *const idxPtr, TICK const timeout)
+{
+	K_CR_AREA
+	K_CR_ENTER
+	if ((kobj == NULL) || (idxPtr == NULL))
+	{
+		KFAULT( FAULT_OBJ_NULL);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NULL);
+	}
+	if (!kobj->init)
+	{
+		KFAULT( FAULT_OBJ_NOT_INIT);
+		K_CR_EXIT
+		return (K_ERR_OBJ_NOT_INIT);
+	}
+	if (IS_BLOCK_ON_ISR( timeout))
+	{
+		KFAULT( FAULT_INVALID_ISR_PRIMITVE);
+	}
+	/* one task waits on a set at a time */
+	if (kobj->ownerPtr != NULL)
+	{
+		K_CR_EXIT
+		return (K_ERROR);
+	}
+	TICK64 deadline = 0;
+	for (;;)
+	{
+		/* in the order items were added */
+		for (ULONG i = 0; i < kobj->nItems; ++i)
+		{
+			ULONG bit = (1UL << i);
+			BOOL ready = (kobj->items[i].objectType == EVENT) ?
+					((kobj->signalled & bit) != 0) :
+					kWaitSetItemReady_( &kobj->items[i]);
+			kobj->signalled &= ~bit;
+			if (ready)
+			{
+				*idxPtr = i;
+				K_CR_EXIT
+				return (K_SUCCESS);
+			}
+		}
+		if (timeout == K_NO_WAIT)
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		/* a notify that lost the race leaves only the time left */
+		if ((timeout > K_NO_WAIT) && (timeout < K_WAIT_FOREVER)
+				&& (kTimeOutLeft( &kobj->timeoutNode, &deadline, timeout)
+						!= K_SUCCESS))
+		{
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		kobj->ownerPtr = runPtr;
+		runPtr->status = BLOCKED;
+		K_PEND_CTXTSWTCH
+		K_CR_EXIT
+		K_CR_ENTER
+		if (runPtr->timeOut)
+		{
+			runPtr->timeOut = FALSE;
+			K_CR_EXIT
+			return (K_ERR_TIMEOUT);
+		}
+		if (K_TIMEOUT_ARMED( &kobj->timeoutNode))
+			kRemoveTimeoutNode( &kobj->timeoutNode);
+	}
+}
+#endif /* K_DEF_WAITSET */
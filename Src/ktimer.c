@@ -29,6 +29,48 @@ TICK kTickGet( void)
     return (runTime.globalTick);
 }
 
+/******************************************************************************
+ * 64-BIT MONOTONIC TIME
+ *****************************************************************************/
+/*
+ * The tick handler runs with interrupts masked, so a reader (task or ISR) can
+ * only be interleaved between its own loads, never in the middle of an
+ * update. Sampling the wrap counter before and after the tick counter and
+ * retrying when they differ is enough to get a coherent pair - no critical
+ * region needed.
+ */
+TICK64 kTimeNow64( VOID)
+{
+    UINT wraps;
+    TICK ticks;
+    do
+    {
+        wraps = runTime.nWraps;
+        DMB
+        ticks = runTime.globalTick;
+        DMB
+    } while (wraps != runTime.nWraps);
+    /* TICK is 32-bit on target */
+    return ((( TICK64) wraps << 32) | ( TICK64) ticks);
+}
+
+/* converts an absolute deadline to a relative timeout for blocking calls.
+ * a deadline already met yields K_NO_WAIT (try once), a far deadline is
+ * clamped just below K_WAIT_FOREVER */
+TICK kTimeUntil( TICK64 const deadline)
+{
+    TICK64 now = kTimeNow64();
+    if (deadline <= now)
+    {
+        return (K_NO_WAIT);
+    }
+    if ((deadline - now) >= ( TICK64) K_WAIT_FOREVER)
+    {
+        return (K_WAIT_FOREVER - 1);
+    }
+    return (( TICK) (deadline - now));
+}
+
 /******************************************************************************
  * BUSY-DELAY
  *****************************************************************************/
@@ -119,6 +161,18 @@ void kSleep( TICK ticks)
     K_CR_EXIT
 }
 
+/* sleep until an absolute time (kTimeNow64() scale) */
+VOID kSleepUntilTime( TICK64 const deadline)
+{
+    TICK ticks = kTimeUntil( deadline);
+    if (ticks == K_NO_WAIT)
+    {
+        /* deadline is due - a zero sleep would never time out */
+        return;
+    }
+    kSleep( ticks);
+}
+
 #if(K_DEF_SCH_TSLICE!=ON)
 
 VOID kSleepUntil( TICK const period)
@@ -239,6 +293,35 @@ K_ERR kTimeOut( K_TIMEOUT_NODE *timeOutNode, TICK timeout)
     return (K_SUCCESS);
 }
 
+/*
+ * For wait loops that can block more than once (a woken task rechecks its
+ * condition and may block again): the first pass sets the deadline and
+ * arms the whole time-out, later ones arm only what is left of it.
+ * K_ERR_TIMEOUT once the deadline has passed. The node may still be armed
+ * by another waiter of the same object; it is moved, not linked twice.
+ */
+K_ERR kTimeOutLeft( K_TIMEOUT_NODE *timeOutNode, TICK64 *deadlinePtr,
+        TICK timeout)
+{
+    if (*deadlinePtr == 0)
+    {
+        *deadlinePtr = kTimeNow64() + timeout;
+    }
+    else
+    {
+        timeout = kTimeUntil( *deadlinePtr);
+        if (timeout == K_NO_WAIT)
+        {
+            return (K_ERR_TIMEOUT);
+        }
+    }
+    if (K_TIMEOUT_ARMED( timeOutNode))
+    {
+        kRemoveTimeoutNode( timeOutNode);
+    }
+    return (kTimeOut( timeOutNode, timeout));
+}
+
 /* Handler traverses the list and process each object accordinly */
 
 K_ERR kRemoveTaskFromPendingOrSleeping( volatile K_TIMEOUT_NODE *node)
@@ -262,6 +345,21 @@ K_ERR kRemoveTaskFromPendingOrSleeping( volatile K_TIMEOUT_NODE *node)
         }
         return (K_SUCCESS);
     }
+#if (K_DEF_CHANNEL==ON)
+    /* a channel client not yet received */
+    else if ((taskPtr->status == SENDING) && (taskPtr->chanPtr != NULL))
+    {
+        K_TCB *remPtr = taskPtr;
+        kTCBQRem( &taskPtr->chanPtr->clientQueue, &remPtr);
+        taskPtr->chanPtr = NULL;
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+        }
+        return (K_SUCCESS);
+    }
+#endif
     return (K_ERROR);
 }
 
@@ -307,6 +405,25 @@ K_ERR kRemoveTaskFromMQueue( volatile K_TIMEOUT_NODE *node)
     return (K_ERROR);
 }
 #endif
+#if (K_DEF_PQUEUE==ON)
+K_ERR kRemoveTaskFromPQueue( volatile K_TIMEOUT_NODE *node)
+{
+
+    K_PQUEUE *pqPtr = K_GET_CONTAINER_ADDR( node, K_PQUEUE, timeoutNode);
+    if (pqPtr->waitingQueue.size > 0)
+    {
+        K_TCB *taskPtr;
+        kTCBQDeq( &pqPtr->waitingQueue, &taskPtr);
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+            return (K_SUCCESS);
+        }
+    }
+    return (K_ERROR);
+}
+#endif
 
 #if (K_DEF_SEMA==ON)
 K_ERR kRemoveTaskFromSema( volatile K_TIMEOUT_NODE *node)
@@ -368,6 +485,123 @@ K_ERR kRemoveTaskFromStream( volatile K_TIMEOUT_NODE *node)
     return (K_ERROR);
 }
 #endif
+#if (K_DEF_PIPE==ON)
+K_ERR kRemoveTaskFromPipe( volatile K_TIMEOUT_NODE *node)
+{
+
+    K_PIPE *pipePtr = K_GET_CONTAINER_ADDR( node, K_PIPE, timeoutNode);
+    if (pipePtr->waitingQueue.size > 0)
+    {
+        K_TCB *taskPtr;
+        kTCBQDeq( &pipePtr->waitingQueue, &taskPtr);
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+            return (K_SUCCESS);
+        }
+    }
+    return (K_ERROR);
+}
+#endif
+#if (K_DEF_SPSC==ON)
+K_ERR kRemoveTaskFromSpsc( volatile K_TIMEOUT_NODE *node)
+{
+
+    K_SPSC *spscPtr = K_GET_CONTAINER_ADDR( node, K_SPSC, timeoutNode);
+    K_TCB *taskPtr = spscPtr->readerPtr;
+    /* the producer may have readied it already */
+    if (taskPtr != NULL)
+    {
+        spscPtr->readerPtr = NULL;
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+            return (K_SUCCESS);
+        }
+    }
+    return (K_ERROR);
+}
+#endif
+#if (K_DEF_MPSC==ON)
+K_ERR kRemoveTaskFromMpsc( volatile K_TIMEOUT_NODE *node)
+{
+
+    K_MPSC *mpscPtr = K_GET_CONTAINER_ADDR( node, K_MPSC, timeoutNode);
+    K_TCB *taskPtr = mpscPtr->readerPtr;
+    /* a producer may have readied it already */
+    if (taskPtr != NULL)
+    {
+        mpscPtr->readerPtr = NULL;
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+            return (K_SUCCESS);
+        }
+    }
+    return (K_ERROR);
+}
+#endif
+#if (K_DEF_BCAST==ON)
+K_ERR kRemoveTaskFromBcast( volatile K_TIMEOUT_NODE *node)
+{
+
+    K_BCAST *bcastPtr = K_GET_CONTAINER_ADDR( node, K_BCAST, timeoutNode);
+    if (bcastPtr->waitingQueue.size > 0)
+    {
+        K_TCB *taskPtr;
+        kTCBQDeq( &bcastPtr->waitingQueue, &taskPtr);
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+            return (K_SUCCESS);
+        }
+    }
+    return (K_ERROR);
+}
+#endif
+#if (K_DEF_WAITSET==ON)
+K_ERR kRemoveTaskFromWaitSet( volatile K_TIMEOUT_NODE *node)
+{
+
+    K_WAIT_SET *setPtr = K_GET_CONTAINER_ADDR( node, K_WAIT_SET, timeoutNode);
+    K_TCB *taskPtr = setPtr->ownerPtr;
+    /* an object may have readied it already */
+    if (taskPtr != NULL)
+    {
+        setPtr->ownerPtr = NULL;
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+            return (K_SUCCESS);
+        }
+    }
+    return (K_ERROR);
+}
+#endif
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+K_ERR kRemoveTaskFromMem( volatile K_TIMEOUT_NODE *node)
+{
+
+    K_MEM *memPtr = K_GET_CONTAINER_ADDR( node, K_MEM, timeoutNode);
+    if (memPtr->waitingQueue.size > 0)
+    {
+        K_TCB *taskPtr;
+        kTCBQDeq( &memPtr->waitingQueue, &taskPtr);
+        taskPtr->timeOut = TRUE;
+        if (!kTCBQEnq( &readyQueue[taskPtr->priority], taskPtr))
+        {
+            taskPtr->status = READY;
+            return (K_SUCCESS);
+        }
+    }
+    return (K_ERROR);
+}
+#endif
 #if (K_DEF_EVENT==ON)
 K_ERR kRemoveTaskFromEvent( volatile K_TIMEOUT_NODE *node)
 {
@@ -419,6 +653,11 @@ BOOL kHandleTimeoutList( VOID)
                 err = kRemoveTaskFromMQueue( node);
                 break;
 #endif
+#if (K_DEF_PQUEUE==ON)
+            case PQUEUE:
+                err = kRemoveTaskFromPQueue( node);
+                break;
+#endif
 #if (K_DEF_SEMA==ON)
             case SEMAPHORE:
                 err = kRemoveTaskFromSema( node);
@@ -438,6 +677,36 @@ BOOL kHandleTimeoutList( VOID)
             case EVENT:
                 err = kRemoveTaskFromEvent( node);
                 break;
+#endif
+#if (K_DEF_FUNC_MEM_ALLOCWAIT==ON)
+            case MEMPOOL:
+                err = kRemoveTaskFromMem( node);
+                break;
+#endif
+#if (K_DEF_WAITSET==ON)
+            case WAITSET:
+                err = kRemoveTaskFromWaitSet( node);
+                break;
+#endif
+#if (K_DEF_PIPE==ON)
+            case PIPE:
+                err = kRemoveTaskFromPipe( node);
+                break;
+#endif
+#if (K_DEF_SPSC==ON)
+            case SPSC:
+                err = kRemoveTaskFromSpsc( node);
+                break;
+#endif
+#if (K_DEF_MPSC==ON)
+            case MPSC:
+                err = kRemoveTaskFromMpsc( node);
+                break;
+#endif
+#if (K_DEF_BCAST==ON)
+            case BCAST:
+                err = kRemoveTaskFromBcast( node);
+                break;
 #endif
             case TASK_HANDLE:
 
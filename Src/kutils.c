@@ -33,15 +33,7 @@ ULONG kMemCpy( ADDR destPtr, ADDR const srcPtr, ULONG size)
 	{
 		kErrHandler( FAULT_OBJ_NULL);
 	}
-	ULONG n = 0;
-	BYTE *destTempPtr = (BYTE*) destPtr;
-	BYTE const *srcTempPtr = (BYTE const*) srcPtr;
-	for (ULONG i = 0; i < size; ++i)
-	{
-		destTempPtr[i] = srcTempPtr[i];
-		n++;
-	}
-	return (n);
+	return (kCpy( destPtr, srcPtr, size));
 }
 #ifdef K_DEF_PRINTF
 /*****************************************************************************
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ *
+ * [K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * Copy engine benchmark: kCpy() and kCpyWords() against the byte loop the
+ * message objects used before, across message sizes
+ *
+ * Each copy is repeated BCPY_REPS times per batch, and the figure is the
+ * best batch of BCPY_BATCHES, in cycles per copy, so interrupts and
+ * preemption on the host drop out. kCpy() runs on word-aligned buffers
+ * (the fast path) and on buffers one byte apart (bytes only). Built
+ * without auto-vectorisation and without memcpy() calls for the loops,
+ * as a Cortex-M build gets; memcpy() is the host library, for reference.
+ *
+ *****************************************************************************/
+
+#include "kexecutive.h"
+#include "kapi.h"
+#include "ktest.h"
+#include <string.h>
+
+#define BCPY_MAX      (1024UL)
+#define BCPY_REPS     (2000UL)
+#define BCPY_BATCHES  (50UL)
+
+typedef VOID (*BCPY_FN)( BYTE*, BYTE const*, ULONG);
+
+static K_WORD srcBuf[(BCPY_MAX / sizeof(K_WORD)) + 1];
+static K_WORD dstBuf[(BCPY_MAX / sizeof(K_WORD)) + 1];
+
+/* the per-byte copy of the former CPY macro */
+static VOID byteLoop( BYTE *d, BYTE const *s, ULONG n)
+{
+	for (ULONG i = 0; i < n; ++i)
+	{
+		d[i] = s[i];
+	}
+}
+static VOID cpy( BYTE *d, BYTE const *s, ULONG n)
+{
+	kCpy( d, ( ADDR) s, n);
+}
+static VOID cpyWords( BYTE *d, BYTE const *s, ULONG n)
+{
+	kCpyWords( (K_WORD*) d, (K_WORD const*) s, n / sizeof(K_WORD));
+}
+static VOID libc( BYTE *d, BYTE const *s, ULONG n)
+{
+	memcpy( d, s, n);
+}
+
+static unsigned long long bench( BCPY_FN const fn, ULONG const size,
+		ULONG const offset)
+{
+	BYTE *d = ( BYTE*) dstBuf + offset;
+	BYTE const *s = ( BYTE const*) srcBuf;
+	unsigned long long best = ~0ULL;
+	for (ULONG b = 0; b < BCPY_BATCHES; ++b)
+	{
+		unsigned long long t0 = kTestCycles();
+		for (ULONG r = 0; r < BCPY_REPS; ++r)
+		{
+			fn( d, s, size);
+			/* keeps every copy */
+			__asm__ volatile ("" : : : "memory");
+		}
+		unsigned long long t = kTestCycles() - t0;
+		if (t < best)
+		{
+			best = t;
+		}
+	}
+	KTEST_CHECK( memcmp( d, s, size) == 0);
+	memset( dstBuf, 0, sizeof(dstBuf));
+	return (best / BCPY_REPS);
+}
+
+int main( void)
+{
+	static const ULONG sizes[] =
+	{ 4, 16, 32, 64, 128, 256, 1024 };
+	for (ULONG i = 0; i < BCPY_MAX; ++i)
+	{
+		(( BYTE*) srcBuf)[i] = ( BYTE) (i * 7U + 1U);
+	}
+	printf( "bcpy: cycles per copy, best of %lu x %lu\n", BCPY_BATCHES,
+			BCPY_REPS);
+	printf( "%6s %8s %8s %8s %8s %8s\n", "size", "bytes", "kCpy",
+			"kCpy+1", "words", "memcpy");
+	for (ULONG i = 0; i < (sizeof(sizes) / sizeof(sizes[0])); ++i)
+	{
+		ULONG size = sizes[i];
+		printf( "%6lu %8llu %8llu %8llu %8llu %8llu\n", size,
+				bench( byteLoop, size, 0), bench( cpy, size, 0),
+				bench( cpy, size, 1), bench( cpyWords, size, 0),
+				bench( libc, size, 0));
+	}
+	return (0);
+}
@@ -0,0 +1,159 @@
+/*****************************************************************************
+ *
+ * [K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * Heap benchmark: kHeapAlloc()/kHeapFree() against a block pool
+ * (kMemAlloc()/kMemFree()) and the host malloc()/free()
+ *
+ * For each size, BHEAP_BURST blocks are taken and then given back in
+ * reverse order, then again in a shuffled order, BHEAP_ROUNDS times.
+ * Every call is timed alone, so the figures are cycles per call (counter
+ * overhead included): mean, 99.9th percentile and worst case. The tail is
+ * what an RTOS allocator is judged by, but on a host the worst case also
+ * catches interrupts and preemption, hence the percentile. Host figures
+ * only rank the allocators; target cycles differ. Built with
+ * KHOST_CR_NONE: a critical region costs nothing here, as masking
+ * interrupts costs next to nothing there.
+ *
+ *****************************************************************************/
+
+#include "kexecutive.h"
+#include "kapi.h"
+#include "kheap.h"
+#include "ktest.h"
+
+#define BHEAP_BURST   (48UL)
+#define BHEAP_ROUNDS  (2000UL)
+
+#define BHEAP_SAMPLES (BHEAP_BURST * BHEAP_ROUNDS)
+
+typedef struct
+{
+	unsigned long long sum;
+	ULONG n;
+	unsigned long long samples[BHEAP_SAMPLES];
+} BHEAP_STAT;
+
+typedef ADDR (*BHEAP_ALLOC)( ULONG);
+typedef VOID (*BHEAP_FREE)( ADDR);
+
+static K_HEAP heap;
+static unsigned long long heapMem[(64 * 1024) / sizeof(unsigned long long)];
+static K_MEM mem;
+static unsigned long long memPool[(BHEAP_BURST * 1024)
+		/ sizeof(unsigned long long)];
+
+static ADDR heapAlloc( ULONG size)
+{
+	return (kHeapAlloc( &heap, size));
+}
+static VOID heapFree( ADDR ptr)
+{
+	kHeapFree( &heap, ptr);
+}
+static ADDR memAlloc( ULONG size)
+{
+	(void) size;
+	return (kMemAlloc( &mem));
+}
+static VOID memFree( ADDR ptr)
+{
+	kMemFree( &mem, ptr);
+}
+static ADDR libcAlloc( ULONG size)
+{
+	return (malloc( size));
+}
+static VOID libcFree( ADDR ptr)
+{
+	free( ptr);
+}
+
+static BHEAP_STAT allocStat;
+static BHEAP_STAT freeStat;
+
+static VOID record( BHEAP_STAT *const statPtr, unsigned long long const t)
+{
+	statPtr->sum += t;
+	statPtr->samples[statPtr->n++] = t;
+}
+
+static int cmpCycles( void const *aPtr, void const *bPtr)
+{
+	unsigned long long a = *(unsigned long long const*) aPtr;
+	unsigned long long b = *(unsigned long long const*) bPtr;
+	return ((a > b) - (a < b));
+}
+
+static VOID report( BHEAP_STAT *const statPtr)
+{
+	qsort( statPtr->samples, statPtr->n, sizeof(statPtr->samples[0]),
+			cmpCycles);
+	printf( " %8llu %8llu %8llu", statPtr->sum / statPtr->n,
+			statPtr->samples[(statPtr->n * 999) / 1000],
+			statPtr->samples[statPtr->n - 1]);
+}
+
+static VOID run( STRING const name, ULONG const size,
+		BHEAP_ALLOC const allocFn, BHEAP_FREE const freeFn)
+{
+	allocStat.sum = 0;
+	allocStat.n = 0;
+	freeStat.sum = 0;
+	freeStat.n = 0;
+	ADDR ptrs[BHEAP_BURST];
+	ULONG order[BHEAP_BURST];
+	unsigned seed = 7U;
+	for (ULONG round = 0; round < BHEAP_ROUNDS; ++round)
+	{
+		for (ULONG i = 0; i < BHEAP_BURST; ++i)
+		{
+			unsigned long long t0 = kTestCycles();
+			ptrs[i] = allocFn( size);
+			record( &allocStat, kTestCycles() - t0);
+			KTEST_CHECK( ptrs[i] != NULL);
+			order[i] = BHEAP_BURST - 1 - i;
+		}
+		/* odd rounds free in a shuffled order, even ones in reverse */
+		for (ULONG i = 0; (round & 1) && (i < BHEAP_BURST); ++i)
+		{
+			ULONG j = ( ULONG) rand_r( &seed) % BHEAP_BURST;
+			ULONG k = order[i];
+			order[i] = order[j];
+			order[j] = k;
+		}
+		for (ULONG i = 0; i < BHEAP_BURST; ++i)
+		{
+			unsigned long long t0 = kTestCycles();
+			freeFn( ptrs[order[i]]);
+			record( &freeStat, kTestCycles() - t0);
+		}
+	}
+	printf( "%-8s %6lu", name, size);
+	report( &allocStat);
+	report( &freeStat);
+	printf( "\n");
+}
+
+int main( void)
+{
+	static const ULONG sizes[] =
+	{ 16, 64, 256, 1024 };
+	KTEST_CHECK( kHeapInit( &heap, heapMem, sizeof(heapMem)) == K_SUCCESS);
+	printf( "bheap: cycles per call, %lu blocks x %lu rounds\n",
+			BHEAP_BURST, BHEAP_ROUNDS);
+	printf( "%-8s %6s %8s %8s %8s %8s %8s %8s\n", "", "size", "alloc",
+			"p99.9", "max", "free", "p99.9", "max");
+	for (ULONG s = 0; s < (sizeof(sizes) / sizeof(sizes[0])); ++s)
+	{
+		KTEST_CHECK( kMemInit( &mem, memPool, sizes[s], BHEAP_BURST)
+				== K_SUCCESS);
+		run( "kMem", sizes[s], memAlloc, memFree);
+		run( "kHeap", sizes[s], heapAlloc, heapFree);
+		run( "malloc", sizes[s], libcAlloc, libcFree);
+		KTEST_CHECK( kHeapCheck( &heap) == K_SUCCESS);
+	}
+	return (0);
+}
@@ -0,0 +1,178 @@
+/*****************************************************************************
+ *
+ * [K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * Module : Host stand-ins
+ * Provides to : test/
+ * Public API : No
+ *
+ * In this unit:
+ * o Scheduler and timer symbols for host builds of kmesg.c, kmem.c,
+ *   kheap.c, ksynch.c and kutils.c
+ *
+ * Host threads are not kernel tasks. The critical region is a recursive
+ * mutex, so the paths that mask interrupts on a target exclude each other
+ * here too; single-threaded benchmarks build with KHOST_CR_NONE to leave
+ * it out. Nothing may block: a test that would pend a task is a broken
+ * test, and every scheduler entry point a blocking call needs aborts it.
+ *
+ *****************************************************************************/
+
+#define K_CODE
+#include "kexecutive.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+unsigned SystemCoreClock = 1000000UL;
+volatile K_FAULT faultID = 0;
+volatile K_TIMEOUT_NODE *timeOutListHeadPtr = NULL;
+K_TCBQ readyQueue[K_DEF_MIN_PRIO + 2];
+K_TCB tcbs[NTHREADS];
+K_TCB *runPtr = &tcbs[0];
+
+#ifndef KHOST_CR_NONE
+static pthread_mutex_t crMutex;
+static pthread_once_t crOnce = PTHREAD_ONCE_INIT;
+
+static VOID kHostCRInit_( VOID)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init( &attr);
+	pthread_mutexattr_settype( &attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init( &crMutex, &attr);
+	pthread_mutexattr_destroy( &attr);
+}
+#endif
+
+static VOID kHostBlock_( STRING const fnName)
+{
+	fprintf( stderr, "khost: %s would block a task\n", fnName);
+	abort();
+}
+
+UINT kEnterCR( VOID)
+{
+#ifndef KHOST_CR_NONE
+	pthread_once( &crOnce, kHostCRInit_);
+	pthread_mutex_lock( &crMutex);
+#endif
+	return (0);
+}
+
+VOID kExitCR( UINT crState)
+{
+	(void) crState;
+#ifndef KHOST_CR_NONE
+	pthread_mutex_unlock( &crMutex);
+#endif
+}
+
+VOID kErrHandler( K_FAULT fault)
+{
+	faultID = fault;
+	fprintf( stderr, "khost: fault %d\n", ( int) fault);
+	abort();
+}
+
+/* milliseconds, as with the default 1 ms tick */
+TICK64 kTimeNow64( VOID)
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts);
+	return ((( TICK64) ts.tv_sec * 1000ULL) + (( TICK64) ts.tv_nsec / 1000000ULL));
+}
+
+K_ERR kTCBQInit( K_TCBQ *const kobj, STRING listName)
+{
+	return (kListInit( kobj, listName));
+}
+
+K_TCB* kTCBQPeek( K_TCBQ *const kobj)
+{
+	K_NODE *nodePtr = kobj->listDummy.nextPtr;
+	return (K_GET_CONTAINER_ADDR( nodePtr, K_TCB, tcbNode));
+}
+
+K_ERR kTCBQEnq( K_TCBQ *const kobj, K_TCB *const tcbPtr)
+{
+	(void) kobj;
+	(void) tcbPtr;
+	kHostBlock_( "kTCBQEnq");
+	return (K_ERROR);
+}
+
+K_ERR kTCBQEnqByPrio( K_TCBQ *const kobj, K_TCB *const tcbPtr)
+{
+	(void) kobj;
+	(void) tcbPtr;
+	kHostBlock_( "kTCBQEnqByPrio");
+	return (K_ERROR);
+}
+
+K_ERR kTCBQJam( K_TCBQ *const kobj, K_TCB *const tcbPtr)
+{
+	(void) kobj;
+	(void) tcbPtr;
+	kHostBlock_( "kTCBQJam");
+	return (K_ERROR);
+}
+
+/* no task is ever enqueued, so there is none to take out */
+K_ERR kTCBQDeq( K_TCBQ *const kobj, K_TCB **const tcbPPtr)
+{
+	(void) kobj;
+	*tcbPPtr = NULL;
+	return (K_ERR_LIST_EMPTY);
+}
+
+K_ERR kTCBQRem( K_TCBQ *const kobj, K_TCB **const tcbPPtr)
+{
+	(void) kobj;
+	(void) tcbPPtr;
+	return (K_ERR_LIST_EMPTY);
+}
+
+K_ERR kReadyCtxtSwtch( K_TCB *const tcbPtr)
+{
+	(void) tcbPtr;
+	kHostBlock_( "kReadyCtxtSwtch");
+	return (K_ERROR);
+}
+
+VOID kSleep( TICK const ticks)
+{
+	(void) ticks;
+	kHostBlock_( "kSleep");
+}
+
+VOID kTCBSetPrio( K_TCB *const tcbPtr, PRIO const prio)
+{
+	tcbPtr->priority = prio;
+}
+
+K_ERR kTimeOut( K_TIMEOUT_NODE *timeOutNode, TICK timeout)
+{
+	(void) timeOutNode;
+	(void) timeout;
+	kHostBlock_( "kTimeOut");
+	return (K_ERROR);
+}
+
+K_ERR kTimeOutLeft( K_TIMEOUT_NODE *timeOutNode, TICK64 *deadlinePtr,
+		TICK timeout)
+{
+	(void) timeOutNode;
+	(void) deadlinePtr;
+	(void) timeout;
+	kHostBlock_( "kTimeOutLeft");
+	return (K_ERROR);
+}
+
+VOID kRemoveTimeoutNode( K_TIMEOUT_NODE *node)
+{
+	(void) node;
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o CMSIS stand-ins for host builds of the kernel sources
+ *
+ *  Force-included (-include khost.h) by test/Makefile, in place of the
+ *  HAL and CMSIS headers kenv.h would pull in on a target. Off ARM the
+ *  kernel takes the K_HOST_ATOMICS path (kinternals.h): C11 atomics and
+ *  fences, and kIsISR() is always 0.
+ *
+ *****************************************************************************/
+
+#ifndef KHOST_H
+#define KHOST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define __ASM                   __asm__
+#define __STATIC_FORCEINLINE    static inline __attribute__((always_inline))
+
+static inline unsigned __get_PRIMASK( void)
+{
+	return (0);
+}
+static inline void __set_PRIMASK( unsigned primask)
+{
+	(void) primask;
+}
+static inline void __disable_irq( void)
+{
+}
+static inline void __enable_irq( void)
+{
+}
+static inline void __DSB( void)
+{
+}
+static inline void __ISB( void)
+{
+}
+static inline void __WFI( void)
+{
+}
+
+/* a pended context switch is a no-op: host threads are not kernel tasks */
+typedef struct
+{
+	volatile uint32_t ICSR;
+} SCB_Type;
+static SCB_Type khostSCB_ __attribute__((unused));
+#define SCB                     (&khostSCB_)
+#define SCB_ICSR_PENDSVSET_Msk  (1UL << 28)
+
+extern unsigned SystemCoreClock;
+
+#endif /* KHOST_H */
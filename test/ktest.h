@@ -0,0 +1,51 @@
+/******************************************************************************
+ *
+ *     [[K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ *  In this header:
+ *                  o Checks and timers shared by the host tests and
+ *                    benchmarks in test/
+ *
+ *****************************************************************************/
+
+#ifndef KTEST_H
+#define KTEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* fails the program at the first broken check, whatever NDEBUG says */
+#define KTEST_CHECK(cond)                                              \
+do                                                                     \
+{                                                                      \
+    if (!(cond))                                                       \
+    {                                                                  \
+        fprintf( stderr, "%s:%d: check failed: %s\n", __FILE__,        \
+                __LINE__, #cond);                                      \
+        exit( EXIT_FAILURE);                                           \
+    }                                                                  \
+} while(0U)
+
+/* monotonic nanoseconds */
+static inline unsigned long long kTestNowNs( void)
+{
+	struct timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (((unsigned long long) ts.tv_sec * 1000000000ULL)
+			+ (unsigned long long) ts.tv_nsec);
+}
+
+/* CPU cycles where the host has a cycle counter, else nanoseconds */
+static inline unsigned long long kTestCycles( void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return (__builtin_ia32_rdtsc());
+#else
+	return (kTestNowNs());
+#endif
+}
+
+#endif /* KTEST_H */
@@ -0,0 +1,144 @@
+/*****************************************************************************
+ *
+ * [K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * TLSF heap randomized test
+ *
+ * A seeded random run of allocations, frees and resizes over THEAP_SLOTS
+ * slots, with kHeapCheck() after every operation. The heap has no realloc,
+ * so a resize is what an application does: allocate the new size, copy
+ * what fits, free the old block. Every block is filled with a pattern of
+ * its slot, checked before it is freed or copied, so an overlap between
+ * blocks shows up. Once everything is freed the heap must be whole again.
+ *
+ *****************************************************************************/
+
+#include "kexecutive.h"
+#include "kheap.h"
+#include "ktest.h"
+#include <string.h>
+
+#define THEAP_SLOTS      (256UL)
+#define THEAP_OPS        (200000UL)
+#define THEAP_SMALL_MAX  (96UL)
+#define THEAP_LARGE_MAX  (3000UL)
+
+static K_HEAP heap;
+/* passed 3 bytes in, misaligned on purpose: kHeapInit() aligns it */
+static unsigned long long heapMem[(32 * 1024) / sizeof(unsigned long long)];
+
+static BYTE *slotPtr[THEAP_SLOTS];
+static ULONG slotSize[THEAP_SLOTS];
+
+static BYTE pattern( ULONG const slot, ULONG const offset)
+{
+	return (( BYTE) ((slot * 31U) + offset));
+}
+
+static VOID fill( ULONG const slot, ULONG const from)
+{
+	for (ULONG k = from; k < slotSize[slot]; ++k)
+	{
+		slotPtr[slot][k] = pattern( slot, k);
+	}
+}
+
+static VOID verify( ULONG const slot)
+{
+	for (ULONG k = 0; k < slotSize[slot]; ++k)
+	{
+		KTEST_CHECK( slotPtr[slot][k] == pattern( slot, k));
+	}
+}
+
+/* mostly small requests, some large ones */
+static ULONG randomSize( unsigned *const seedPtr)
+{
+	unsigned r = rand_r( seedPtr);
+	ULONG max = ((r & 3U) != 0U) ? THEAP_SMALL_MAX : THEAP_LARGE_MAX;
+	return (1 + (( ULONG) rand_r( seedPtr) % max));
+}
+
+int main( void)
+{
+	KTEST_CHECK( kHeapInit( &heap, ( BYTE*) heapMem + 3,
+			sizeof(heapMem) - 3) == K_SUCCESS);
+	KTEST_CHECK( kHeapCheck( &heap) == K_SUCCESS);
+	ULONG initFree = kHeapFreeBytes( &heap);
+	unsigned seed = 1U;
+	ULONG nAlloc = 0, nFree = 0, nResize = 0, nFail = 0;
+	for (ULONG op = 0; op < THEAP_OPS; ++op)
+	{
+		ULONG slot = ( ULONG) rand_r( &seed) % THEAP_SLOTS;
+		if (slotPtr[slot] == NULL)
+		{
+			ULONG size = randomSize( &seed);
+			BYTE *ptr = kHeapAlloc( &heap, size);
+			if (ptr == NULL)
+			{
+				nFail++;
+			}
+			else
+			{
+				KTEST_CHECK( (( ULONG) ptr & (K_HEAP_ALIGN - 1)) == 0);
+				slotPtr[slot] = ptr;
+				slotSize[slot] = size;
+				fill( slot, 0);
+				nAlloc++;
+			}
+		}
+		else if ((rand_r( &seed) & 1) != 0)
+		{
+			verify( slot);
+			KTEST_CHECK( kHeapFree( &heap, slotPtr[slot]) == K_SUCCESS);
+			slotPtr[slot] = NULL;
+			nFree++;
+		}
+		else
+		{
+			verify( slot);
+			ULONG size = randomSize( &seed);
+			BYTE *ptr = kHeapAlloc( &heap, size);
+			if (ptr == NULL)
+			{
+				nFail++;
+			}
+			else
+			{
+				ULONG keep = (size < slotSize[slot]) ? size : slotSize[slot];
+				memcpy( ptr, slotPtr[slot], keep);
+				KTEST_CHECK( kHeapFree( &heap, slotPtr[slot]) == K_SUCCESS);
+				slotPtr[slot] = ptr;
+				slotSize[slot] = size;
+				/* the copied part keeps the pattern of the slot */
+				fill( slot, keep);
+				verify( slot);
+				nResize++;
+			}
+		}
+		KTEST_CHECK( kHeapCheck( &heap) == K_SUCCESS);
+	}
+	for (ULONG slot = 0; slot < THEAP_SLOTS; ++slot)
+	{
+		if (slotPtr[slot] != NULL)
+		{
+			verify( slot);
+			KTEST_CHECK( kHeapFree( &heap, slotPtr[slot]) == K_SUCCESS);
+			KTEST_CHECK( kHeapCheck( &heap) == K_SUCCESS);
+		}
+	}
+	/* all merged back: one block, taken whole but for the good-fit
+	 * rounding of at most one list range */
+	KTEST_CHECK( kHeapFreeBytes( &heap) == initFree);
+	BYTE *allPtr = kHeapAlloc( &heap,
+			initFree - (initFree >> K_DEF_HEAP_SL_LOG2) - K_HEAP_ALIGN);
+	KTEST_CHECK( allPtr != NULL);
+	KTEST_CHECK( kHeapCheck( &heap) == K_SUCCESS);
+	KTEST_CHECK( kHeapFree( &heap, allPtr) == K_SUCCESS);
+	KTEST_CHECK( kHeapFreeBytes( &heap) == initFree);
+	printf( "theap: ok (%lu ops: %lu allocs, %lu frees, %lu resizes, "
+			"%lu out of memory)\n", THEAP_OPS, nAlloc, nFree, nResize, nFail);
+	return (0);
+}
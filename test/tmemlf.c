@@ -0,0 +1,145 @@
+/*****************************************************************************
+ *
+ * [K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * Lock-free block pool stress test (K_MEM_LOCKFREE on K_HOST_ATOMICS)
+ *
+ * TMEMLF_THREADS threads take and give back blocks of a small pool, one
+ * at a time and in batches (kMemAllocN()/kMemFreeN()), so the tagged head
+ * of the free list is popped and pushed back under their feet all along.
+ * An owner table claimed with an atomic exchange catches a block handed
+ * out twice, and each thread stamps the blocks it holds and checks the
+ * stamp before giving them back. At the end every block must be back in
+ * the pool: nFreeBlocks is full and allocating all of it yields each
+ * block once.
+ *
+ *****************************************************************************/
+
+#include "kexecutive.h"
+#include "kapi.h"
+#include "ktest.h"
+#include <pthread.h>
+#include <stdatomic.h>
+
+#if (K_MEM_LOCKFREE!=ON)
+#error "tmemlf needs K_DEF_ALLOC_LOCKFREE (see test/Makefile)"
+#endif
+
+#define TMEMLF_THREADS   (8UL)
+#define TMEMLF_ITERS     (400000UL)
+#define TMEMLF_BLOCKS    (64UL)
+#define TMEMLF_WORDS     (4UL)
+#define TMEMLF_HELD      (16UL)
+#define TMEMLF_BATCH     (4UL)
+
+static K_MEM mem;
+static ULONG pool[TMEMLF_BLOCKS][TMEMLF_WORDS];
+#if (K_DEF_ALLOC_CHECK==ON)
+static ULONG allocMap[K_MEM_MAP_WORDS(TMEMLF_BLOCKS)];
+#endif
+static atomic_uint owner[TMEMLF_BLOCKS];
+
+static ULONG blockIdx( ADDR const blockPtr)
+{
+	ULONG idx = ( ULONG) (( ULONG*) blockPtr - &pool[0][0]) / TMEMLF_WORDS;
+	KTEST_CHECK( idx < TMEMLF_BLOCKS);
+	KTEST_CHECK( blockPtr == pool[idx]);
+	return (idx);
+}
+
+/* the block was free: nobody else holds it */
+static VOID take( ADDR const blockPtr, ULONG const stamp)
+{
+	ULONG idx = blockIdx( blockPtr);
+	KTEST_CHECK( atomic_exchange( &owner[idx], 1U) == 0U);
+	for (ULONG w = 0; w < TMEMLF_WORDS; ++w)
+	{
+		(( volatile ULONG*) blockPtr)[w] = stamp;
+	}
+}
+
+/* nobody wrote the block while it was held */
+static VOID give( ADDR const blockPtr, ULONG const stamp)
+{
+	ULONG idx = blockIdx( blockPtr);
+	for (ULONG w = 0; w < TMEMLF_WORDS; ++w)
+	{
+		KTEST_CHECK( (( volatile ULONG*) blockPtr)[w] == stamp);
+	}
+	atomic_store( &owner[idx], 0U);
+}
+
+static void* worker( void *argPtr)
+{
+	ULONG stamp = ( ULONG) argPtr + 1;
+	ADDR held[TMEMLF_HELD];
+	ULONG nHeld = 0;
+	unsigned seed = ( unsigned) stamp;
+	for (ULONG it = 0; it < TMEMLF_ITERS; ++it)
+	{
+		unsigned r = rand_r( &seed);
+		BOOL batch = ((r & 0x30U) == 0U);
+		if ((nHeld < (TMEMLF_HELD - TMEMLF_BATCH)) && (r & 1U))
+		{
+			ULONG n = batch ?
+					kMemAllocN( &mem, &held[nHeld], TMEMLF_BATCH) :
+					((held[nHeld] = kMemAlloc( &mem)) != NULL);
+			for (ULONG i = 0; i < n; ++i)
+			{
+				take( held[nHeld++], stamp);
+			}
+		}
+		else if (nHeld > 0)
+		{
+			ULONG n = (batch && (nHeld >= TMEMLF_BATCH)) ? TMEMLF_BATCH : 1;
+			nHeld -= n;
+			for (ULONG i = 0; i < n; ++i)
+			{
+				give( held[nHeld + i], stamp);
+			}
+			KTEST_CHECK( ((n == 1) ? kMemFree( &mem, held[nHeld]) :
+					kMemFreeN( &mem, &held[nHeld], n)) == K_SUCCESS);
+		}
+	}
+	while (nHeld > 0)
+	{
+		nHeld--;
+		give( held[nHeld], stamp);
+		KTEST_CHECK( kMemFree( &mem, held[nHeld]) == K_SUCCESS);
+	}
+	return (NULL);
+}
+
+int main( void)
+{
+	KTEST_CHECK( kMemInit( &mem, pool, sizeof(pool[0]), TMEMLF_BLOCKS)
+			== K_SUCCESS);
+#if (K_DEF_ALLOC_CHECK==ON)
+	/* a block freed twice is refused, not pushed twice */
+	KTEST_CHECK( kMemCheckInit( &mem, allocMap) == K_SUCCESS);
+#endif
+	pthread_t threads[TMEMLF_THREADS];
+	for (ULONG t = 0; t < TMEMLF_THREADS; ++t)
+	{
+		KTEST_CHECK( pthread_create( &threads[t], NULL, worker,
+				( void*) t) == 0);
+	}
+	for (ULONG t = 0; t < TMEMLF_THREADS; ++t)
+	{
+		KTEST_CHECK( pthread_join( threads[t], NULL) == 0);
+	}
+	/* none lost: the whole pool comes out, each block once */
+	KTEST_CHECK( mem.nFreeBlocks == TMEMLF_BLOCKS);
+	for (ULONG i = 0; i < TMEMLF_BLOCKS; ++i)
+	{
+		ADDR blockPtr = kMemAlloc( &mem);
+		KTEST_CHECK( blockPtr != NULL);
+		take( blockPtr, 0);
+	}
+	KTEST_CHECK( kMemAlloc( &mem) == NULL);
+	printf( "tmemlf: ok (%lu threads, %lu blocks, %lu iterations each)\n",
+			TMEMLF_THREADS, TMEMLF_BLOCKS, TMEMLF_ITERS);
+	return (0);
+}
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ *
+ * [K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * MPSC queue stress test (K_HOST_ATOMICS)
+ *
+ * TMPSC_PRODUCERS threads post numbered messages to a small queue while
+ * the main thread takes them. Each message carries its producer and its
+ * number, so the consumer checks that every producer's messages arrive
+ * once each and in order: none lost, none duplicated. The second run
+ * starts the free-running positions just below the ULONG wrap point, so
+ * they overflow halfway through.
+ *
+ *****************************************************************************/
+
+#include "kexecutive.h"
+#include "kapi.h"
+#include "ktest.h"
+#include <pthread.h>
+#include <sched.h>
+
+#define TMPSC_PRODUCERS   (4UL)
+#define TMPSC_PER_PRODUCER (200000UL)
+#define TMPSC_CELLS       (16UL)
+#define TMPSC_ID_SHIFT    (24U)
+#define TMPSC_NUM_MASK    ((1UL << TMPSC_ID_SHIFT) - 1)
+
+static K_MPSC mpsc;
+static K_MPSC_CELL cells[TMPSC_CELLS];
+
+static void* producer( void *argPtr)
+{
+	ULONG id = ( ULONG) argPtr;
+	ULONG num = 1;
+	while (num <= TMPSC_PER_PRODUCER)
+	{
+		if (kMpscPost( &mpsc, ( ADDR) ((id << TMPSC_ID_SHIFT) | num))
+				== K_SUCCESS)
+		{
+			num++;
+		}
+		else
+		{
+			sched_yield();
+		}
+	}
+	return (NULL);
+}
+
+/* puts the positions of an empty queue at 'base' */
+static VOID rebase( ULONG const base)
+{
+	for (ULONG i = 0; i < TMPSC_CELLS; ++i)
+	{
+		cells[(base + i) & mpsc.mask].seq = base + i;
+	}
+	mpsc.postPos = base;
+	mpsc.pendPos = base;
+}
+
+static VOID run( ULONG const base)
+{
+	KTEST_CHECK( kMpscInit( &mpsc, cells, TMPSC_CELLS) == K_SUCCESS);
+	rebase( base);
+	pthread_t threads[TMPSC_PRODUCERS];
+	for (ULONG id = 0; id < TMPSC_PRODUCERS; ++id)
+	{
+		KTEST_CHECK( pthread_create( &threads[id], NULL, producer,
+				( void*) id) == 0);
+	}
+	ULONG last[TMPSC_PRODUCERS] =
+	{ 0 };
+	ULONG got = 0;
+	while (got < (TMPSC_PRODUCERS * TMPSC_PER_PRODUCER))
+	{
+		ADDR mesgPtr;
+		if (kMpscPend( &mpsc, &mesgPtr, K_NO_WAIT) != K_SUCCESS)
+		{
+			sched_yield();
+			continue;
+		}
+		ULONG id = ( ULONG) mesgPtr >> TMPSC_ID_SHIFT;
+		ULONG num = ( ULONG) mesgPtr & TMPSC_NUM_MASK;
+		KTEST_CHECK( id < TMPSC_PRODUCERS);
+		/* a gap is a lost message, a repeat a duplicated one */
+		KTEST_CHECK( num == (last[id] + 1));
+		last[id] = num;
+		got++;
+	}
+	for (ULONG id = 0; id < TMPSC_PRODUCERS; ++id)
+	{
+		KTEST_CHECK( pthread_join( threads[id], NULL) == 0);
+		KTEST_CHECK( last[id] == TMPSC_PER_PRODUCER);
+	}
+	ADDR mesgPtr;
+	KTEST_CHECK( kMpscPend( &mpsc, &mesgPtr, K_NO_WAIT) == K_ERR_MBOX_EMPTY);
+	KTEST_CHECK( mpsc.pendPos == (base + got));
+}
+
+int main( void)
+{
+	/* bounds, and FIFO order from a single producer */
+	KTEST_CHECK( kMpscInit( &mpsc, cells, 3) == K_ERR_INVALID_QUEUE_SIZE);
+	KTEST_CHECK( kMpscInit( &mpsc, cells, 4) == K_SUCCESS);
+	ADDR mesgPtr;
+	for (ULONG i = 1; i <= 4; ++i)
+	{
+		KTEST_CHECK( kMpscPost( &mpsc, ( ADDR) i) == K_SUCCESS);
+	}
+	KTEST_CHECK( kMpscPost( &mpsc, ( ADDR) 5UL) == K_ERR_MBOX_FULL);
+	for (ULONG i = 1; i <= 4; ++i)
+	{
+		KTEST_CHECK( kMpscPend( &mpsc, &mesgPtr, K_NO_WAIT) == K_SUCCESS);
+		KTEST_CHECK( ( ULONG) mesgPtr == i);
+	}
+	KTEST_CHECK( kMpscPend( &mpsc, &mesgPtr, K_NO_WAIT) == K_ERR_MBOX_EMPTY);
+
+	run( 0);
+	/* positions overflow halfway through */
+	run( ( ULONG) 0 - ((TMPSC_PRODUCERS * TMPSC_PER_PRODUCER) / 2));
+	printf( "tmpsc: ok (%lu producers, %lu messages per run)\n",
+			TMPSC_PRODUCERS, TMPSC_PRODUCERS * TMPSC_PER_PRODUCER);
+	return (0);
+}
@@ -0,0 +1,89 @@
+/*****************************************************************************
+ *
+ * [K0BA - Kernel 0 For Embedded Applications] | [VERSION: 0.4.0]
+ *
+ ******************************************************************************
+ ******************************************************************************
+ * Wait set membership test
+ *
+ * A Queue, an Event and a Semaphore go into set A. The Queue cannot join
+ * set B while it is in A; once removed from A it can, and from then on
+ * its posts are reported by B only. The members after it move down one
+ * index, their latched signals with them. Initialising A again lets its
+ * other members go, so they can join B too. Only K_NO_WAIT calls.
+ *
+ *****************************************************************************/
+
+#include "kexecutive.h"
+#include "kapi.h"
+#include "ktest.h"
+
+static K_WAIT_SET setA;
+static K_WAIT_SET setB;
+static K_QUEUE queue;
+static ADDR queueBuf[4];
+static K_EVENT event;
+static K_SEMA sema;
+
+static ULONG ready( K_WAIT_SET *const setPtr)
+{
+	ULONG idx = ~0UL;
+	KTEST_CHECK( kWaitAny( setPtr, &idx, K_NO_WAIT) == K_SUCCESS);
+	return (idx);
+}
+
+int main( void)
+{
+	static ULONG mesg = 1;
+	ADDR recvPtr = NULL;
+	ULONG idx = 0;
+	KTEST_CHECK( kQueueInit( &queue, queueBuf, 4) == K_SUCCESS);
+	KTEST_CHECK( kEventInit( &event) == K_SUCCESS);
+	KTEST_CHECK( kSemaInit( &sema, 0) == K_SUCCESS);
+	KTEST_CHECK( kWaitSetInit( &setA) == K_SUCCESS);
+	KTEST_CHECK( kWaitSetInit( &setB) == K_SUCCESS);
+
+	KTEST_CHECK( kWaitSetAdd( &setA, QUEUE, &queue) == K_SUCCESS);
+	KTEST_CHECK( kWaitSetAdd( &setA, EVENT, &event) == K_SUCCESS);
+	KTEST_CHECK( kWaitSetAdd( &setA, SEMAPHORE, &sema) == K_SUCCESS);
+	KTEST_CHECK( kWaitSetAdd( &setB, QUEUE, &queue) == K_ERROR);
+	KTEST_CHECK( kWaitAny( &setA, &idx, K_NO_WAIT) == K_ERR_TIMEOUT);
+
+	/* latched on index 1, reported on index 0 once the Queue is out */
+	kEventSignal( &event);
+	KTEST_CHECK( kWaitSetRemove( &setA, &queue) == K_SUCCESS);
+	KTEST_CHECK( kWaitSetRemove( &setA, &queue) == K_ERROR);
+	KTEST_CHECK( queue.waitSetPtr == NULL);
+	KTEST_CHECK( event.waitSetBit == (1UL << 0));
+	KTEST_CHECK( sema.waitSetBit == (1UL << 1));
+	KTEST_CHECK( ready( &setA) == 0);
+	KTEST_CHECK( kWaitAny( &setA, &idx, K_NO_WAIT) == K_ERR_TIMEOUT);
+
+	/* the Queue now belongs to B alone */
+	KTEST_CHECK( kWaitSetAdd( &setB, QUEUE, &queue) == K_SUCCESS);
+	KTEST_CHECK( queue.waitSetPtr == &setB);
+	KTEST_CHECK( kQueuePost( &queue, &mesg, K_NO_WAIT) == K_SUCCESS);
+	KTEST_CHECK( kWaitAny( &setA, &idx, K_NO_WAIT) == K_ERR_TIMEOUT);
+	KTEST_CHECK( ready( &setB) == 0);
+	KTEST_CHECK( kQueuePend( &queue, &recvPtr, K_NO_WAIT) == K_SUCCESS);
+	KTEST_CHECK( recvPtr == &mesg);
+	KTEST_CHECK( kWaitAny( &setB, &idx, K_NO_WAIT) == K_ERR_TIMEOUT);
+
+	kSemaSignal( &sema);
+	KTEST_CHECK( ready( &setA) == 1);
+
+	/* initialised again, A lets the Event and the Semaphore go */
+	KTEST_CHECK( kWaitSetInit( &setA) == K_SUCCESS);
+	KTEST_CHECK( event.waitSetPtr == NULL);
+	KTEST_CHECK( sema.waitSetPtr == NULL);
+	KTEST_CHECK( kWaitSetAdd( &setB, SEMAPHORE, &sema) == K_SUCCESS);
+	KTEST_CHECK( ready( &setB) == 1);
+	KTEST_CHECK( kWaitSetAdd( &setB, EVENT, &event) == K_SUCCESS);
+	kEventSignal( &event);
+	KTEST_CHECK( kWaitAny( &setA, &idx, K_NO_WAIT) == K_ERR_TIMEOUT);
+	KTEST_CHECK( kSemaWait( &sema, K_NO_WAIT) == K_SUCCESS);
+	KTEST_CHECK( ready( &setB) == 2);
+	KTEST_CHECK( kWaitAny( &setB, &idx, K_NO_WAIT) == K_ERR_TIMEOUT);
+	printf( "twaitset: ok\n");
+	return (0);
+}